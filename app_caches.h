@@ -0,0 +1,271 @@
+// app_caches.h
+// Fixed-capacity application caches for the cache policy benchmark: LRU over
+// an intrusive doubly linked list, CLOCK over flat arrays, segmented LRU and a
+// lock-striped sharded wrapper. Keys and values are uint32_t (UINT32_MAX is
+// reserved) and every policy uses the same open-addressing key -> slot index,
+// so differences come from the replacement metadata.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Open-addressing map from key to slot with linear probing and backward-shift
+// deletion, kept at most half full
+class SlotIndex {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    explicit SlotIndex(size_t capacity) {
+        size_t size = 2;
+        while (size < 2 * capacity) size *= 2;
+        table_.assign(size, {NONE, NONE});
+        for (size_t s = size; s > 1; s /= 2) shift_--;
+    }
+
+    uint32_t find(uint32_t key) const {
+        for (size_t i = home(key); ; i = (i + 1) & mask()) {
+            if (table_[i].key == key) return table_[i].slot;
+            if (table_[i].key == NONE) return NONE;
+        }
+    }
+
+    void insert(uint32_t key, uint32_t slot) {
+        size_t i = home(key);
+        while (table_[i].key != NONE) i = (i + 1) & mask();
+        table_[i] = {key, slot};
+    }
+
+    void erase(uint32_t key) {
+        size_t i = home(key);
+        while (table_[i].key != key) i = (i + 1) & mask();
+        // Pull back later entries of the probe run that may no longer be reachable
+        for (size_t j = (i + 1) & mask(); table_[j].key != NONE; j = (j + 1) & mask()) {
+            size_t h = home(table_[j].key);
+            if (((j - h) & mask()) >= ((j - i) & mask())) {
+                table_[i] = table_[j];
+                i = j;
+            }
+        }
+        table_[i] = {NONE, NONE};
+    }
+
+    size_t bytes() const { return table_.size() * sizeof(Entry); }
+
+private:
+    struct Entry { uint32_t key, slot; };
+
+    size_t mask() const { return table_.size() - 1; }
+    size_t home(uint32_t key) const { return (key * 0x9e3779b1u) >> shift_; } // Fibonacci hashing
+
+    std::vector<Entry> table_;
+    int shift_ = 32;
+};
+
+// Slots with intrusive prev/next links; each list has a sentinel slot past the
+// data slots, so splicing never branches on empty lists
+class LinkedSlots {
+protected:
+    struct Node { uint32_t key, value, prev, next; };
+
+    LinkedSlots(size_t capacity, size_t lists) : nodes_(capacity + lists) {
+        for (size_t l = 0; l < lists; l++) {
+            uint32_t s = sentinel(l);
+            nodes_[s].prev = nodes_[s].next = s;
+        }
+    }
+
+    uint32_t sentinel(size_t list) const { return static_cast<uint32_t>(nodes_.size() - 1 - list); }
+
+    void unlink(uint32_t i) {
+        nodes_[nodes_[i].prev].next = nodes_[i].next;
+        nodes_[nodes_[i].next].prev = nodes_[i].prev;
+    }
+
+    void pushFront(size_t list, uint32_t i) {
+        uint32_t s = sentinel(list);
+        nodes_[i].prev = s;
+        nodes_[i].next = nodes_[s].next;
+        nodes_[nodes_[s].next].prev = i;
+        nodes_[s].next = i;
+    }
+
+    uint32_t back(size_t list) const { return nodes_[sentinel(list)].prev; }
+
+    std::vector<Node> nodes_;
+};
+
+// Classic LRU: every hit splices its node to the front of the list, which
+// writes the node and both neighbours
+class LruCache : private LinkedSlots {
+public:
+    explicit LruCache(size_t capacity) : LinkedSlots(capacity, 1), index_(capacity), capacity_(capacity) {}
+
+    // Returns true on a hit; on a miss stores load(key), evicting the least recently used entry
+    template<typename Load>
+    bool lookup(uint32_t key, uint32_t& value, Load load) {
+        uint32_t i = index_.find(key);
+        if (i != SlotIndex::NONE) {
+            unlink(i);
+            pushFront(0, i);
+            value = nodes_[i].value;
+            return true;
+        }
+        if (size_ < capacity_) {
+            i = static_cast<uint32_t>(size_++);
+        } else {
+            i = back(0);
+            unlink(i);
+            index_.erase(nodes_[i].key);
+        }
+        value = load(key);
+        nodes_[i].key = key;
+        nodes_[i].value = value;
+        pushFront(0, i);
+        index_.insert(key, i);
+        return false;
+    }
+
+    size_t bytes() const { return nodes_.size() * sizeof(Node) + index_.bytes(); }
+
+private:
+    SlotIndex index_;
+    size_t capacity_, size_ = 0;
+};
+
+// CLOCK (second chance): hits only set a reference byte; misses sweep the hand
+// over the flat arrays clearing bits until an unreferenced slot is found
+class ClockCache {
+public:
+    explicit ClockCache(size_t capacity)
+        : keys_(capacity), values_(capacity), referenced_(capacity), index_(capacity) {}
+
+    template<typename Load>
+    bool lookup(uint32_t key, uint32_t& value, Load load) {
+        uint32_t i = index_.find(key);
+        if (i != SlotIndex::NONE) {
+            referenced_[i] = 1;
+            value = values_[i];
+            return true;
+        }
+        if (size_ < keys_.size()) {
+            i = static_cast<uint32_t>(size_++);
+        } else {
+            while (referenced_[hand_]) {
+                referenced_[hand_] = 0;
+                hand_ = hand_ + 1 == keys_.size() ? 0 : hand_ + 1;
+            }
+            i = static_cast<uint32_t>(hand_);
+            hand_ = hand_ + 1 == keys_.size() ? 0 : hand_ + 1;
+            index_.erase(keys_[i]);
+        }
+        value = load(key);
+        keys_[i] = key;
+        values_[i] = value;
+        referenced_[i] = 1;
+        index_.insert(key, i);
+        return false;
+    }
+
+    size_t bytes() const { return keys_.size() * (2 * sizeof(uint32_t) + 1) + index_.bytes(); }
+
+private:
+    std::vector<uint32_t> keys_, values_;
+    std::vector<uint8_t> referenced_;
+    SlotIndex index_;
+    size_t size_ = 0, hand_ = 0;
+};
+
+// Segmented LRU: new keys enter a probationary list and move to a protected
+// list (80% of capacity) on their second hit, so one-time scans only churn
+// the probationary segment
+class SegmentedLruCache : private LinkedSlots {
+public:
+    explicit SegmentedLruCache(size_t capacity)
+        : LinkedSlots(capacity, 2), segment_(capacity), index_(capacity),
+          capacity_(capacity), protectedCapacity_(capacity * 4 / 5) {}
+
+    template<typename Load>
+    bool lookup(uint32_t key, uint32_t& value, Load load) {
+        uint32_t i = index_.find(key);
+        if (i != SlotIndex::NONE) {
+            unlink(i);
+            pushFront(PROTECTED, i);
+            if (segment_[i] == PROBATION) {
+                segment_[i] = PROTECTED;
+                if (++protectedSize_ > protectedCapacity_) {
+                    uint32_t demoted = back(PROTECTED);
+                    unlink(demoted);
+                    pushFront(PROBATION, demoted);
+                    segment_[demoted] = PROBATION;
+                    protectedSize_--;
+                }
+            }
+            value = nodes_[i].value;
+            return true;
+        }
+        if (size_ < capacity_) {
+            i = static_cast<uint32_t>(size_++);
+        } else {
+            // The probationary list is only empty when the protected one holds everything
+            i = back(PROBATION) != sentinel(PROBATION) ? back(PROBATION) : back(PROTECTED);
+            if (segment_[i] == PROTECTED) protectedSize_--;
+            unlink(i);
+            index_.erase(nodes_[i].key);
+        }
+        value = load(key);
+        nodes_[i].key = key;
+        nodes_[i].value = value;
+        segment_[i] = PROBATION;
+        pushFront(PROBATION, i);
+        index_.insert(key, i);
+        return false;
+    }
+
+    size_t bytes() const { return nodes_.size() * sizeof(Node) + segment_.size() + index_.bytes(); }
+
+private:
+    static constexpr uint8_t PROBATION = 0, PROTECTED = 1;
+
+    std::vector<uint8_t> segment_;
+    SlotIndex index_;
+    size_t capacity_, protectedCapacity_, size_ = 0, protectedSize_ = 0;
+};
+
+// Splits the capacity over independently locked shards selected by a second
+// hash of the key; each shard is cache-line aligned so locks do not false-share
+template<typename Cache>
+class ShardedCache {
+public:
+    ShardedCache(size_t capacity, size_t shards) {
+        size_t count = 1;
+        while (count < shards) count *= 2;
+        for (size_t s = 0; s < count; s++) {
+            shards_.emplace_back(new Shard((capacity + count - 1) / count));
+        }
+    }
+
+    template<typename Load>
+    bool lookup(uint32_t key, uint32_t& value, Load load) {
+        Shard& shard = *shards_[((key * 0x85ebca6bu) >> 16) & (shards_.size() - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.lookup(key, value, load);
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) total += sizeof(Shard) + shard->cache.bytes();
+        return total;
+    }
+
+private:
+    struct alignas(64) Shard {
+        explicit Shard(size_t capacity) : cache(capacity) {}
+        std::mutex mutex;
+        Cache cache;
+    };
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
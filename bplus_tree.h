@@ -0,0 +1,175 @@
+// bplus_tree.h
+// Static (bulk-loaded) B+tree over unique uint32_t keys with uint32_t values,
+// templated on the node size in bytes. Inner and leaf nodes are cache-line
+// aligned; in-node search is binary (std::upper_bound) or a linear scan that
+// compares eight keys at a time with AVX2 when available, and lookups can
+// prefetch every line of the chosen child before searching it (as in
+// prefetching B+-trees).
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "prefetch.h"
+
+template<size_t NODE_BYTES>
+class BPlusTree {
+public:
+    static_assert(NODE_BYTES >= 64 && NODE_BYTES % 64 == 0, "nodes are whole cache lines");
+    static constexpr size_t KEYS = (NODE_BYTES - 8) / 8; // Same fan-out for inner and leaf nodes
+
+    // `keys` must be sorted and unique
+    BPlusTree(const std::vector<uint32_t>& keys, const std::vector<uint32_t>& values) {
+        std::vector<uint32_t> levelMin, nextMin;
+        for (size_t start = 0; start < keys.size() || start == 0; start += KEYS) {
+            Leaf leaf;
+            leaf.count = static_cast<uint32_t>(std::min(KEYS, keys.size() - start));
+            leaf.next = static_cast<uint32_t>(leaves_.size() + 1);
+            for (size_t i = 0; i < KEYS; i++) {
+                leaf.keys[i] = i < leaf.count ? keys[start + i] : std::numeric_limits<uint32_t>::max();
+                leaf.values[i] = i < leaf.count ? values[start + i] : 0;
+            }
+            levelMin.push_back(leaf.count ? leaf.keys[0] : 0);
+            leaves_.push_back(leaf);
+            if (keys.empty()) break;
+        }
+        leaves_.back().next = NONE;
+
+        // Build inner levels bottom-up; children of the first level are leaves
+        size_t levelStart = 0, levelSize = leaves_.size();
+        while (levelSize > 1 || height_ == 0) {
+            nextMin.clear();
+            size_t nextStart = inner_.size();
+            for (size_t first = 0; first < levelSize; first += KEYS + 1) {
+                Inner node;
+                size_t children = std::min(KEYS + 1, levelSize - first);
+                node.count = static_cast<uint32_t>(children - 1);
+                for (size_t c = 0; c <= KEYS; c++) {
+                    node.children[c] = c < children ? static_cast<uint32_t>(levelStart + first + c) : 0;
+                    if (c > 0 && c - 1 < KEYS) {
+                        node.keys[c - 1] = c < children ? levelMin[first + c] : std::numeric_limits<uint32_t>::max();
+                    }
+                }
+                nextMin.push_back(levelMin[first]);
+                inner_.push_back(node);
+            }
+            levelMin.swap(nextMin);
+            levelStart = nextStart;
+            levelSize = inner_.size() - nextStart;
+            height_++;
+            if (levelSize == 1) break;
+        }
+        root_ = static_cast<uint32_t>(inner_.size() - 1);
+    }
+
+    int height() const { return height_; }
+    size_t bytes() const { return (inner_.size() + leaves_.size()) * NODE_BYTES; }
+
+    template<bool SIMD, bool PREFETCH>
+    bool find(uint32_t key, uint32_t& value) const {
+        const Leaf& leaf = leaves_[descend<SIMD, PREFETCH>(key)];
+        size_t pos = SIMD ? countLess(leaf.keys, leaf.count, key)
+                          : std::lower_bound(leaf.keys, leaf.keys + leaf.count, key) - leaf.keys;
+        if (pos < leaf.count && leaf.keys[pos] == key) {
+            value = leaf.values[pos];
+            return true;
+        }
+        return false;
+    }
+
+    // Sums the values of up to `count` entries starting at the first key >= `from`
+    template<bool PREFETCH>
+    uint64_t scan(uint32_t from, size_t count) const {
+        uint32_t node = descend<false, PREFETCH>(from);
+        const Leaf* leaf = &leaves_[node];
+        size_t pos = std::lower_bound(leaf->keys, leaf->keys + leaf->count, from) - leaf->keys;
+        uint64_t sum = 0;
+        while (count > 0) {
+            // Prefetch only the header and value lines of the next leaf that this scan will read
+            size_t remaining = count > leaf->count - pos ? count - (leaf->count - pos) : 0;
+            if (PREFETCH && remaining > 0 && leaf->next != NONE) {
+                const Leaf& next = leaves_[leaf->next];
+                prefetch_read(&next);
+                for (size_t v = 0; v < std::min(remaining, KEYS); v += 16) prefetch_read(&next.values[v]);
+            }
+            for (; pos < leaf->count && count > 0; pos++, count--) sum += leaf->values[pos];
+            if (leaf->next == NONE) break;
+            leaf = &leaves_[leaf->next];
+            pos = 0;
+        }
+        return sum;
+    }
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct alignas(64) Inner {
+        uint32_t count;
+        uint32_t keys[KEYS];        // keys[i] = smallest key under children[i + 1]
+        uint32_t children[KEYS + 1];
+    };
+    struct alignas(64) Leaf {
+        uint32_t count, next;
+        uint32_t keys[KEYS];
+        uint32_t values[KEYS];
+    };
+    static_assert(sizeof(Inner) == NODE_BYTES && sizeof(Leaf) == NODE_BYTES, "node layout must fill NODE_BYTES");
+
+    static void prefetchNode(const void* node) {
+        for (size_t line = 0; line < NODE_BYTES; line += 64) {
+            prefetch_read(static_cast<const char*>(node) + line);
+        }
+    }
+
+    // Linear rank of `key` among sorted keys[0, count): number of keys < key
+    static size_t countLess(const uint32_t* keys, size_t count, uint32_t key) {
+        size_t i = 0, rank = 0;
+#ifdef __AVX2__
+        // AVX2 only compares signed lanes, so bias both sides by 2^31
+        const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+        const __m256i probe = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), bias);
+        for (; i + 8 <= count; i += 8) {
+            __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(probe, block)));
+            rank += std::bitset<8>(static_cast<unsigned>(mask)).count();
+            if (mask != 0xff) return rank; // Keys are sorted: nothing further is smaller
+        }
+#endif
+        for (; i < count; i++) {
+            if (keys[i] >= key) break;
+            rank++;
+        }
+        return rank;
+    }
+
+    // Returns the leaf that may contain `key`
+    template<bool SIMD, bool PREFETCH>
+    uint32_t descend(uint32_t key) const {
+        uint32_t node = root_;
+        for (int level = 0; level < height_; level++) {
+            const Inner& in = inner_[node];
+            // Child index = number of separators <= key
+            size_t child = SIMD ? (key == NONE ? in.count : countLess(in.keys, in.count, key + 1))
+                                : std::upper_bound(in.keys, in.keys + in.count, key) - in.keys;
+            node = in.children[child];
+            if (PREFETCH) {
+                if (level + 1 < height_) prefetchNode(&inner_[node]);
+                else prefetchNode(&leaves_[node]);
+            }
+        }
+        return node;
+    }
+
+    std::vector<Inner> inner_;
+    std::vector<Leaf> leaves_;
+    uint32_t root_ = 0;
+    int height_ = 0;
+};
@@ -0,0 +1,154 @@
+// cache_oblivious.h
+// Cache-oblivious recursive kernels and explicitly blocked counterparts whose
+// tile sizes are picked from the cache hierarchy. Matrices are square,
+// row-major n x n uint32_t with wrapping arithmetic, so both variants must
+// produce bit-identical results.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Recursion stops once a sub-problem has at most this many elements
+constexpr size_t OBLIVIOUS_LEAF = 256;
+
+inline void transpose_oblivious_rec(const uint32_t* a, uint32_t* b, size_t n,
+                                    size_t r0, size_t r1, size_t c0, size_t c1) {
+    size_t rows = r1 - r0, cols = c1 - c0;
+    if (rows * cols <= OBLIVIOUS_LEAF) {
+        for (size_t r = r0; r < r1; r++) {
+            for (size_t c = c0; c < c1; c++) {
+                b[c * n + r] = a[r * n + c];
+            }
+        }
+    } else if (rows >= cols) {
+        size_t mid = r0 + rows / 2;
+        transpose_oblivious_rec(a, b, n, r0, mid, c0, c1);
+        transpose_oblivious_rec(a, b, n, mid, r1, c0, c1);
+    } else {
+        size_t mid = c0 + cols / 2;
+        transpose_oblivious_rec(a, b, n, r0, r1, c0, mid);
+        transpose_oblivious_rec(a, b, n, r0, r1, mid, c1);
+    }
+}
+
+// b = a^T
+inline void transpose_oblivious(const uint32_t* a, uint32_t* b, size_t n) {
+    transpose_oblivious_rec(a, b, n, 0, n, 0, n);
+}
+
+inline void transpose_blocked(const uint32_t* a, uint32_t* b, size_t n, size_t tile) {
+    for (size_t ii = 0; ii < n; ii += tile) {
+        for (size_t jj = 0; jj < n; jj += tile) {
+            size_t iEnd = std::min(ii + tile, n), jEnd = std::min(jj + tile, n);
+            for (size_t r = ii; r < iEnd; r++) {
+                for (size_t c = jj; c < jEnd; c++) {
+                    b[c * n + r] = a[r * n + c];
+                }
+            }
+        }
+    }
+}
+
+// c[i0..i1, j0..j1] += a[i0..i1, k0..k1] * b[k0..k1, j0..j1]; i-k-j order so
+// the innermost loop streams rows of b and c
+inline void matmul_kernel(const uint32_t* a, const uint32_t* b, uint32_t* c, size_t n,
+                          size_t i0, size_t i1, size_t k0, size_t k1, size_t j0, size_t j1) {
+    for (size_t i = i0; i < i1; i++) {
+        for (size_t k = k0; k < k1; k++) {
+            uint32_t aik = a[i * n + k];
+            for (size_t j = j0; j < j1; j++) {
+                c[i * n + j] += aik * b[k * n + j];
+            }
+        }
+    }
+}
+
+inline void matmul_oblivious_rec(const uint32_t* a, const uint32_t* b, uint32_t* c, size_t n,
+                                 size_t i0, size_t i1, size_t k0, size_t k1, size_t j0, size_t j1) {
+    size_t di = i1 - i0, dk = k1 - k0, dj = j1 - j0;
+    if (di * dk <= OBLIVIOUS_LEAF * 4 && dk * dj <= OBLIVIOUS_LEAF * 4) {
+        matmul_kernel(a, b, c, n, i0, i1, k0, k1, j0, j1);
+    } else if (di >= dk && di >= dj) {
+        matmul_oblivious_rec(a, b, c, n, i0, i0 + di / 2, k0, k1, j0, j1);
+        matmul_oblivious_rec(a, b, c, n, i0 + di / 2, i1, k0, k1, j0, j1);
+    } else if (dj >= dk) {
+        matmul_oblivious_rec(a, b, c, n, i0, i1, k0, k1, j0, j0 + dj / 2);
+        matmul_oblivious_rec(a, b, c, n, i0, i1, k0, k1, j0 + dj / 2, j1);
+    } else {
+        matmul_oblivious_rec(a, b, c, n, i0, i1, k0, k0 + dk / 2, j0, j1);
+        matmul_oblivious_rec(a, b, c, n, i0, i1, k0 + dk / 2, k1, j0, j1);
+    }
+}
+
+// c = a * b
+inline void matmul_oblivious(const uint32_t* a, const uint32_t* b, uint32_t* c, size_t n) {
+    std::fill(c, c + n * n, 0u);
+    matmul_oblivious_rec(a, b, c, n, 0, n, 0, n, 0, n);
+}
+
+inline void matmul_blocked(const uint32_t* a, const uint32_t* b, uint32_t* c, size_t n, size_t tile) {
+    std::fill(c, c + n * n, 0u);
+    for (size_t ii = 0; ii < n; ii += tile) {
+        for (size_t kk = 0; kk < n; kk += tile) {
+            for (size_t jj = 0; jj < n; jj += tile) {
+                matmul_kernel(a, b, c, n, ii, std::min(ii + tile, n), kk, std::min(kk + tile, n),
+                              jj, std::min(jj + tile, n));
+            }
+        }
+    }
+}
+
+// Top-down recursive merge sort: oblivious to cache sizes, each level halves
+// the problem until it fits whatever cache is present
+inline void merge_sort_oblivious_rec(uint32_t* data, uint32_t* tmp, size_t n) {
+    if (n <= 16) {
+        for (size_t i = 1; i < n; i++) {
+            uint32_t v = data[i];
+            size_t j = i;
+            for (; j > 0 && data[j - 1] > v; j--) data[j] = data[j - 1];
+            data[j] = v;
+        }
+        return;
+    }
+    size_t half = n / 2;
+    merge_sort_oblivious_rec(data, tmp, half);
+    merge_sort_oblivious_rec(data + half, tmp + half, n - half);
+    std::merge(data, data + half, data + half, data + n, tmp);
+    std::copy(tmp, tmp + n, data);
+}
+
+inline void merge_sort_oblivious(std::vector<uint32_t>& data, std::vector<uint32_t>& tmp) {
+    tmp.resize(data.size());
+    merge_sort_oblivious_rec(data.data(), tmp.data(), data.size());
+}
+
+// Blocked sort: sort cache-sized runs in place, then one k-way heap merge, so
+// main memory is streamed twice regardless of n
+inline void merge_sort_blocked(std::vector<uint32_t>& data, std::vector<uint32_t>& tmp, size_t runLength) {
+    size_t n = data.size();
+    tmp.resize(n);
+    for (size_t start = 0; start < n; start += runLength) {
+        merge_sort_oblivious_rec(data.data() + start, tmp.data() + start, std::min(runLength, n - start));
+    }
+    if (runLength >= n) return;
+
+    using Head = std::pair<uint32_t, size_t>; // (value, run index)
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<size_t> pos, end;
+    for (size_t start = 0; start < n; start += runLength) {
+        pos.push_back(start);
+        end.push_back(std::min(start + runLength, n));
+        heads.push({data[start], pos.size() - 1});
+    }
+    for (size_t out = 0; out < n; out++) {
+        Head h = heads.top();
+        heads.pop();
+        tmp[out] = h.first;
+        if (++pos[h.second] < end[h.second]) heads.push({data[pos[h.second]], h.second});
+    }
+    data.swap(tmp);
+}
@@ -0,0 +1,62 @@
+// cache_topology.h
+// Data cache sizes and line size of the current machine, read from sysfs on
+// Linux and GetLogicalProcessorInformation on Windows; other platforms (and
+// failed reads) keep the fallback sizes.
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#endif
+
+struct CacheTopology {
+    size_t l1d = 32 * 1024;        // Fallbacks when detection fails
+    size_t l2 = 1024 * 1024;
+    size_t l3 = 8 * 1024 * 1024;
+    size_t lineSize = 64;
+};
+
+inline CacheTopology detect_cache_topology() {
+    CacheTopology topo;
+#ifdef _WIN32
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &length)) {
+        for (const auto& entry : info) {
+            if (entry.Relationship != RelationCache || entry.Cache.Type == CacheInstruction) continue;
+            if (entry.Cache.Level == 1) topo.l1d = entry.Cache.Size;
+            if (entry.Cache.Level == 2) topo.l2 = entry.Cache.Size;
+            if (entry.Cache.Level == 3) topo.l3 = entry.Cache.Size;
+            topo.lineSize = entry.Cache.LineSize;
+        }
+    }
+#elif defined(__linux__)
+    for (int index = 0; index < 8; index++) {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+        std::ifstream levelFile(dir + "level"), typeFile(dir + "type"), sizeFile(dir + "size"), lineFile(dir + "coherency_line_size");
+        int level = 0;
+        std::string type, size;
+        if (!(levelFile >> level) || !(typeFile >> type) || !(sizeFile >> size)) break;
+        if (type == "Instruction") continue;
+        
+        // Sizes are reported as e.g. "48K" or "32M"
+        size_t bytes = std::stoul(size);
+        if (size.back() == 'K') bytes *= 1024;
+        if (size.back() == 'M') bytes *= 1024 * 1024;
+        if (level == 1) topo.l1d = bytes;
+        if (level == 2) topo.l2 = bytes;
+        if (level == 3) topo.l3 = bytes;
+        lineFile >> topo.lineSize;
+    }
+#endif
+    return topo;
+}
@@ -0,0 +1,139 @@
+// column_scan.h
+// Filter and gather kernels over a uint32_t column for the columnar scan
+// benchmark. The predicate is `value <= limit`; filters emit either a
+// selection vector of qualifying row ids or a bitmap with one bit per row,
+// and the gathers read a second column through either representation.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Selection vector with an if per row: cheap when the branch is predictable
+// (selectivity near 0% or 100%), one mispredict per surprise otherwise
+inline size_t select_branchy(const uint32_t* col, size_t n, uint32_t limit, uint32_t* sel) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (col[i] <= limit) sel[k++] = static_cast<uint32_t>(i);
+    }
+    return k;
+}
+
+// Always writes the row id and advances the output by the predicate result
+inline size_t select_branchless(const uint32_t* col, size_t n, uint32_t limit, uint32_t* sel) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        sel[k] = static_cast<uint32_t>(i);
+        k += col[i] <= limit;
+    }
+    return k;
+}
+
+#ifdef __AVX2__
+// Lane permutation that packs the selected lanes of an 8-bit mask to the front
+inline const __m256i* select_compress_table() {
+    static const struct Table {
+        alignas(32) uint32_t lanes[256][8];
+        Table() {
+            for (int mask = 0; mask < 256; mask++) {
+                int k = 0;
+                for (int lane = 0; lane < 8; lane++) {
+                    if (mask & (1 << lane)) lanes[mask][k++] = static_cast<uint32_t>(lane);
+                }
+                while (k < 8) lanes[mask][k++] = 0;
+            }
+        }
+    } table;
+    return reinterpret_cast<const __m256i*>(table.lanes);
+}
+
+// Eight-row mask of `value <= limit`; AVX2 only compares signed lanes, so both sides are biased by 2^31
+inline int select_mask8(const uint32_t* col, __m256i biasedLimit) {
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    __m256i values = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(col)), bias);
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(values, biasedLimit))) & 0xff;
+}
+#endif
+
+// Eight rows per step: compare, then compress the matching row ids with a
+// permutation table (sel needs 7 slots of slack past the last match)
+inline size_t select_simd(const uint32_t* col, size_t n, uint32_t limit, uint32_t* sel) {
+    size_t i = 0, k = 0;
+#ifdef __AVX2__
+    const __m256i* table = select_compress_table();
+    const __m256i biasedLimit = _mm256_set1_epi32(static_cast<int>(limit ^ 0x80000000u));
+    __m256i rows = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    for (; i + 8 <= n; i += 8) {
+        int mask = select_mask8(col + i, biasedLimit);
+        __m256i packed = _mm256_permutevar8x32_epi32(rows, _mm256_load_si256(table + mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sel + k), packed);
+        k += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+        rows = _mm256_add_epi32(rows, step);
+    }
+#endif
+    size_t tail = select_branchless(col + i, n - i, limit, sel + k);
+    for (size_t j = k; j < k + tail; j++) sel[j] += static_cast<uint32_t>(i); // Tail ids are relative to i
+    return k + tail;
+}
+
+// Bitmap with one bit per row (bits needs (n + 63) / 64 words); returns the match count
+inline size_t bitmap_scalar(const uint32_t* col, size_t n, uint32_t limit, uint64_t* bits) {
+    size_t count = 0;
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = base + 64 < n ? base + 64 : n;
+        uint64_t word = 0;
+        for (size_t i = base; i < end; i++) word |= static_cast<uint64_t>(col[i] <= limit) << (i - base);
+        bits[base / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return count;
+}
+
+inline size_t bitmap_simd(const uint32_t* col, size_t n, uint32_t limit, uint64_t* bits) {
+    size_t base = 0, count = 0;
+#ifdef __AVX2__
+    const __m256i biasedLimit = _mm256_set1_epi32(static_cast<int>(limit ^ 0x80000000u));
+    for (; base + 64 <= n; base += 64) {
+        uint64_t word = 0;
+        for (int chunk = 0; chunk < 8; chunk++) {
+            word |= static_cast<uint64_t>(select_mask8(col + base + 8 * chunk, biasedLimit)) << (8 * chunk);
+        }
+        bits[base / 64] = word;
+        count += static_cast<size_t>(__builtin_popcountll(word));
+    }
+#endif
+    return count + bitmap_scalar(col + base, n - base, limit, bits + base / 64);
+}
+
+// Sums col[sel[j]]: the `indices` gather, one dependent-free load per match
+inline uint64_t gather_selection(const uint32_t* col, const uint32_t* sel, size_t k) {
+    uint64_t sum = 0;
+    for (size_t j = 0; j < k; j++) sum += col[sel[j]];
+    return sum;
+}
+
+// Walks the set bits of each word, so the cost follows the match count
+inline uint64_t gather_bitmap_sparse(const uint32_t* col, const uint64_t* bits, size_t n) {
+    uint64_t sum = 0;
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+        for (uint64_t word = bits[w]; word; word &= word - 1) {
+            sum += col[w * 64 + static_cast<size_t>(__builtin_ctzll(word))];
+        }
+    }
+    return sum;
+}
+
+// Reads every row and masks out the unselected ones: a sequential scan
+// whose cost does not depend on selectivity
+inline uint64_t gather_bitmap_dense(const uint32_t* col, const uint64_t* bits, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t selected = (bits[i / 64] >> (i % 64)) & 1;
+        sum += col[i] & (0 - selected);
+    }
+    return sum;
+}
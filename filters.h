@@ -0,0 +1,215 @@
+// filters.h
+// Approximate membership filters for the filter probe benchmark. All sizes are
+// rounded down to powers of two so probe positions are computed with masks.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// MurmurHash3 64-bit finalizer
+inline uint64_t filter_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+inline size_t floor_pow2(size_t n) {
+    size_t p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+// Classic Bloom filter: k probes spread over the whole bit array, so every
+// probe of a large filter is an independent cache miss
+class BloomFilter {
+public:
+    BloomFilter(size_t bytes, int k) : words_(floor_pow2(bytes) / sizeof(uint64_t)), k_(k) {
+        mask_ = words_.size() * 64 - 1;
+    }
+
+    void insert(uint64_t key) {
+        uint64_t h = filter_hash(key);
+        uint64_t h1 = h, h2 = (h >> 32) | 1;
+        for (int i = 0; i < k_; i++) {
+            uint64_t bit = (h1 + i * h2) & mask_;
+            words_[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    bool contains(uint64_t key) const {
+        uint64_t h = filter_hash(key);
+        uint64_t h1 = h, h2 = (h >> 32) | 1;
+        for (int i = 0; i < k_; i++) {
+            uint64_t bit = (h1 + i * h2) & mask_;
+            if (!(words_[bit / 64] & (1ULL << (bit % 64)))) return false;
+        }
+        return true;
+    }
+
+    size_t bytes() const { return words_.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> words_;
+    uint64_t mask_;
+    int k_;
+};
+
+// Cache-line-blocked Bloom filter: the key selects one 64-byte block and all
+// k probes stay inside it, so a lookup costs at most one miss
+class BlockedBloomFilter {
+public:
+    BlockedBloomFilter(size_t bytes, int k) : blocks_(floor_pow2(bytes) / sizeof(Block)), k_(k) {}
+
+    void insert(uint64_t key) {
+        uint64_t h = filter_hash(key);
+        Block& block = blocks_[(h >> 32) & (blocks_.size() - 1)];
+        uint32_t h1 = static_cast<uint32_t>(h), h2 = static_cast<uint32_t>(h >> 16) | 1;
+        for (int i = 0; i < k_; i++) {
+            uint32_t bit = (h1 + i * h2) & 511;
+            block.words[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    bool contains(uint64_t key) const {
+        uint64_t h = filter_hash(key);
+        const Block& block = blocks_[(h >> 32) & (blocks_.size() - 1)];
+        uint32_t h1 = static_cast<uint32_t>(h), h2 = static_cast<uint32_t>(h >> 16) | 1;
+        bool found = true;
+        for (int i = 0; i < k_; i++) {
+            uint32_t bit = (h1 + i * h2) & 511;
+            found &= (block.words[bit / 64] >> (bit % 64)) & 1; // Branch-free: the line is loaded anyway
+        }
+        return found;
+    }
+
+    size_t bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    struct alignas(64) Block { uint64_t words[8]; };
+    std::vector<Block> blocks_;
+    int k_;
+};
+
+// Register-blocked (split block) Bloom filter: a 256-bit block with one bit
+// per 32-bit lane, so insert and lookup are a handful of SIMD instructions
+class RegisterBlockedBloomFilter {
+public:
+    explicit RegisterBlockedBloomFilter(size_t bytes) : blocks_(floor_pow2(bytes) / sizeof(Block)) {}
+
+    void insert(uint64_t key) {
+        uint64_t h = filter_hash(key);
+        Block& block = blocks_[(h >> 32) & (blocks_.size() - 1)];
+#ifdef __AVX2__
+        __m256i* lanes = reinterpret_cast<__m256i*>(block.lanes);
+        _mm256_store_si256(lanes, _mm256_or_si256(_mm256_load_si256(lanes), laneMask(static_cast<uint32_t>(h))));
+#else
+        for (int i = 0; i < 8; i++) block.lanes[i] |= 1u << ((static_cast<uint32_t>(h) * SALT[i]) >> 27);
+#endif
+    }
+
+    bool contains(uint64_t key) const {
+        uint64_t h = filter_hash(key);
+        const Block& block = blocks_[(h >> 32) & (blocks_.size() - 1)];
+#ifdef __AVX2__
+        __m256i lanes = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.lanes));
+        return _mm256_testc_si256(lanes, laneMask(static_cast<uint32_t>(h)));
+#else
+        uint32_t missing = 0;
+        for (int i = 0; i < 8; i++) missing |= ~block.lanes[i] & (1u << ((static_cast<uint32_t>(h) * SALT[i]) >> 27));
+        return missing == 0;
+#endif
+    }
+
+    size_t bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    static constexpr uint32_t SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                         0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    struct alignas(32) Block { uint32_t lanes[8]; };
+
+#ifdef __AVX2__
+    static __m256i laneMask(uint32_t h) {
+        __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(SALT));
+        __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h)), salt), 27);
+        return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+    }
+#endif
+
+    std::vector<Block> blocks_;
+};
+
+// Cuckoo filter with 4-slot buckets of 16-bit fingerprints (partial-key cuckoo
+// hashing): a lookup reads at most two buckets
+class CuckooFilter {
+public:
+    explicit CuckooFilter(size_t bytes) : buckets_(floor_pow2(bytes) / sizeof(Bucket)) {}
+
+    // False when the filter is too full to place the key
+    bool insert(uint64_t key) {
+        uint64_t h = filter_hash(key);
+        uint16_t fp = fingerprint(h);
+        size_t i1 = h & mask(), i2 = alternate(i1, fp);
+        if (place(i1, fp) || place(i2, fp)) return true;
+
+        size_t i = (h >> 32) & 1 ? i1 : i2;
+        for (int kick = 0; kick < MAX_KICKS; kick++) {
+            kickState_ = kickState_ * 6364136223846793005ULL + 1442695040888963407ULL;
+            uint16_t& victim = buckets_[i].slots[(kickState_ >> 62) & 3];
+            std::swap(fp, victim);
+            i = alternate(i, fp);
+            if (place(i, fp)) return true;
+        }
+        return false;
+    }
+
+    bool contains(uint64_t key) const {
+        uint64_t h = filter_hash(key);
+        uint16_t fp = fingerprint(h);
+        size_t i1 = h & mask(), i2 = alternate(i1, fp);
+        const Bucket& b1 = buckets_[i1];
+        const Bucket& b2 = buckets_[i2];
+        bool found = false;
+        for (int s = 0; s < SLOTS; s++) found |= (b1.slots[s] == fp) | (b2.slots[s] == fp);
+        return found;
+    }
+
+    size_t bytes() const { return buckets_.size() * sizeof(Bucket); }
+
+private:
+    static constexpr int SLOTS = 4;
+    static constexpr int MAX_KICKS = 500;
+    struct Bucket { uint16_t slots[SLOTS] = {0, 0, 0, 0}; }; // 0 marks an empty slot
+
+    size_t mask() const { return buckets_.size() - 1; }
+
+    static uint16_t fingerprint(uint64_t h) {
+        uint16_t fp = static_cast<uint16_t>(h >> 48);
+        return fp ? fp : 1;
+    }
+
+    size_t alternate(size_t bucket, uint16_t fp) const {
+        return (bucket ^ filter_hash(fp)) & mask();
+    }
+
+    bool place(size_t bucket, uint16_t fp) {
+        for (auto& slot : buckets_[bucket].slots) {
+            if (slot == 0) {
+                slot = fp;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Bucket> buckets_;
+    uint64_t kickState_ = 0x853c49e6748fea9bULL;
+};
@@ -0,0 +1,203 @@
+// gather.h
+// Reusable gather, out[j] = base[indices[j]], with the loop strategy picked
+// from per-machine tuning by the size of `base`:
+//   plain      - straight loop, relying on out-of-order execution
+//   prefetch   - software prefetch `prefetchDistance` elements ahead
+//   simd       - AVX2 hardware gather (4- and 8-byte elements)
+//   batch-sort - sorts each batch of indices first so loads walk memory in order
+//   partition  - radix-partitions the indices into regions of `partitionBytes`
+//                in passes of at most GATHER_PARTITION_FANOUT buckets, then
+//                gathers region by region so each stays cache resident
+// The `gather` benchmark mode calibrates the tuning on the current machine
+// and `calibrate` stores it in a profile (memory_profile.h). Without either,
+// the default tuning picks by the detected cache sizes.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "cache_topology.h"
+#include "prefetch.h"
+
+enum class GatherStrategy { Plain, Prefetch, Simd, BatchSort, Partition };
+
+inline const std::vector<GatherStrategy>& gather_strategies() {
+    static const std::vector<GatherStrategy> all = {
+        GatherStrategy::Plain, GatherStrategy::Prefetch, GatherStrategy::Simd,
+        GatherStrategy::BatchSort, GatherStrategy::Partition
+    };
+    return all;
+}
+
+inline const char* gather_strategy_name(GatherStrategy strategy) {
+    switch (strategy) {
+        case GatherStrategy::Plain: return "plain";
+        case GatherStrategy::Prefetch: return "prefetch";
+        case GatherStrategy::Simd: return "simd";
+        case GatherStrategy::BatchSort: return "batch-sort";
+        case GatherStrategy::Partition: return "partition";
+    }
+    return "plain";
+}
+
+// False when `name` is not a strategy name
+inline bool parse_gather_strategy(const std::string& name, GatherStrategy& strategy) {
+    for (GatherStrategy s : gather_strategies()) {
+        if (name == gather_strategy_name(s)) {
+            strategy = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct GatherTuning {
+    size_t prefetchDistance = 16;          // Elements ahead
+    size_t batchSize = 4096;               // Indices sorted together by batch-sort
+    size_t partitionBytes = 1024 * 1024;   // Region of `base` per partition
+    // (largest base size in bytes, strategy), ascending; larger bases use the last entry
+    std::vector<std::pair<size_t, GatherStrategy>> bySize;
+
+    GatherStrategy choose(size_t baseBytes) const {
+        for (const auto& entry : bySize) {
+            if (baseBytes <= entry.first) return entry.second;
+        }
+        return bySize.empty() ? GatherStrategy::Prefetch : bySize.back().second;
+    }
+};
+
+// Tuning used when none is passed; calibration or a stored profile replaces
+// it. Until then the strategy goes by working-set size: plain while the base
+// fits in L2, where out-of-order execution hides the latency, prefetch beyond
+inline GatherTuning& default_gather_tuning() {
+    static GatherTuning tuning = [] {
+        GatherTuning fallback;
+        fallback.bySize = {{detect_cache_topology().l2, GatherStrategy::Plain},
+                           {std::numeric_limits<size_t>::max(), GatherStrategy::Prefetch}};
+        return fallback;
+    }();
+    return tuning;
+}
+
+template<typename T>
+void gather_plain(const T* base, const size_t* indices, size_t n, T* out) {
+    for (size_t j = 0; j < n; j++) out[j] = base[indices[j]];
+}
+
+template<typename T>
+void gather_prefetch(const T* base, const size_t* indices, size_t n, T* out, size_t distance) {
+    size_t j = 0;
+    for (; j + distance < n; j++) {
+        prefetch_read(base + indices[j + distance]);
+        out[j] = base[indices[j]];
+    }
+    for (; j < n; j++) out[j] = base[indices[j]];
+}
+
+template<typename T>
+void gather_simd(const T* base, const size_t* indices, size_t n, T* out) {
+    size_t j = 0;
+#ifdef __AVX2__
+    if constexpr (sizeof(T) == 4) {
+        for (; j + 4 <= n; j += 4) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + j));
+            __m128i values = _mm256_i64gather_epi32(reinterpret_cast<const int*>(base), idx, 4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), values);
+        }
+    } else if constexpr (sizeof(T) == 8) {
+        for (; j + 4 <= n; j += 4) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + j));
+            __m256i values = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(base), idx, 8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), values);
+        }
+    }
+#endif
+    gather_plain(base, indices + j, n - j, out + j);
+}
+
+// Each batch is packed as (index << 20 | position) and sorted, so indices
+// must stay below 2^44 and batchSize at most 2^20
+template<typename T>
+void gather_batch_sort(const T* base, const size_t* indices, size_t n, T* out, size_t batchSize) {
+    static thread_local std::vector<uint64_t> keys;
+    batchSize = std::min<size_t>(std::max<size_t>(batchSize, 1), size_t(1) << 20);
+    keys.resize(batchSize);
+    for (size_t start = 0; start < n; start += batchSize) {
+        size_t count = std::min(batchSize, n - start);
+        for (size_t j = 0; j < count; j++) keys[j] = static_cast<uint64_t>(indices[start + j]) << 20 | j;
+        std::sort(keys.begin(), keys.begin() + count);
+        T* batchOut = out + start;
+        for (size_t j = 0; j < count; j++) {
+            batchOut[keys[j] & ((1u << 20) - 1)] = base[keys[j] >> 20];
+        }
+    }
+}
+
+// Buckets per partitioning pass: 64 scatter streams keep their current lines
+// in L1 and their pages within first-level TLB reach
+constexpr size_t GATHER_PARTITION_FANOUT = 64;
+
+// Sorts (index, position) pairs by partition (index >> log2 of
+// `partitionBytes` / sizeof(T)) with stable radix passes of at most
+// GATHER_PARTITION_FANOUT buckets, least significant digit first, as many as
+// the partition count needs; then gathers partition by partition
+template<typename T>
+void gather_partition(const T* base, size_t baseCount, const size_t* indices, size_t n, T* out,
+                      size_t partitionBytes) {
+    int shift = 0;
+    while ((sizeof(T) << (shift + 1)) <= partitionBytes) shift++;
+    size_t partitions = ((baseCount - 1) >> shift) + 1;
+    if (partitions <= 1 || n == 0) {
+        gather_plain(base, indices, n, out);
+        return;
+    }
+
+    int digitBits = 0;
+    while ((size_t(2) << digitBits) <= GATHER_PARTITION_FANOUT) digitBits++;
+    const size_t mask = (size_t(1) << digitBits) - 1;
+    static thread_local std::vector<size_t> offsets;
+    static thread_local std::vector<std::pair<size_t, size_t>> pairs, scratch;
+    pairs.resize(n);
+    scratch.resize(n);
+    for (size_t j = 0; j < n; j++) pairs[j] = {indices[j], j};
+    for (int digit = shift; ((partitions - 1) >> (digit - shift)) != 0; digit += digitBits) {
+        offsets.assign(mask + 2, 0);
+        for (const auto& pair : pairs) offsets[((pair.first >> digit) & mask) + 1]++;
+        for (size_t b = 0; b <= mask; b++) offsets[b + 1] += offsets[b];
+        for (const auto& pair : pairs) scratch[offsets[(pair.first >> digit) & mask]++] = pair;
+        pairs.swap(scratch);
+    }
+    for (const auto& pair : pairs) out[pair.second] = base[pair.first]; // Partitions are now contiguous
+}
+
+template<typename T>
+void gather_with(GatherStrategy strategy, const T* base, size_t baseCount, const size_t* indices, size_t n, T* out,
+                 const GatherTuning& tuning) {
+    switch (strategy) {
+        case GatherStrategy::Plain: gather_plain(base, indices, n, out); break;
+        case GatherStrategy::Prefetch: gather_prefetch(base, indices, n, out, tuning.prefetchDistance); break;
+        case GatherStrategy::Simd: gather_simd(base, indices, n, out); break;
+        case GatherStrategy::BatchSort: gather_batch_sort(base, indices, n, out, tuning.batchSize); break;
+        case GatherStrategy::Partition:
+            gather_partition(base, baseCount, indices, n, out, tuning.partitionBytes);
+            break;
+    }
+}
+
+// out[j] = base[indices[j]] using the strategy tuned for base's size
+template<typename T>
+void gather(const std::vector<T>& base, const std::vector<size_t>& indices, std::vector<T>& out,
+            const GatherTuning& tuning = default_gather_tuning()) {
+    out.resize(indices.size());
+    gather_with(tuning.choose(base.size() * sizeof(T)), base.data(), base.size(), indices.data(), indices.size(),
+                out.data(), tuning);
+}
@@ -0,0 +1,165 @@
+// heaps.h
+// Min-priority queues for the heap layout benchmark: implicit d-ary heaps
+// (optionally with every sibling group on its own cache line) and a pairing
+// heap with pooled nodes. Ordering comes from `Less`.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Allocator for cache-line (or larger) aligned std::vector storage
+template<typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+    template<typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    bool operator==(const AlignedAllocator&) const { return true; }
+    bool operator!=(const AlignedAllocator&) const { return false; }
+};
+
+// Implicit D-ary heap. With ALIGNED, storage starts on a cache line and is
+// shifted by D - 1 slots so the D children of node i occupy exactly line
+// i + 1 when D * sizeof(T) == 64 (LaMarca & Ladner's aligned d-heap).
+template<typename T, size_t D, bool ALIGNED, typename Less>
+class DaryHeap {
+public:
+    static constexpr size_t OFFSET = ALIGNED ? D - 1 : 0;
+
+    explicit DaryHeap(Less less = Less()) : less_(less), items_(OFFSET) {}
+
+    void reserve(size_t n) { items_.reserve(n + OFFSET); }
+    size_t size() const { return items_.size() - OFFSET; }
+    bool empty() const { return size() == 0; }
+    const T& top() const { return at(0); }
+
+    void push(const T& value) {
+        items_.push_back(value);
+        size_t i = size() - 1;
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!less_(value, at(parent))) break;
+            at(i) = at(parent);
+            i = parent;
+        }
+        at(i) = value;
+    }
+
+    void pop() {
+        T last = items_.back();
+        items_.pop_back();
+        size_t n = size();
+        if (n == 0) return;
+
+        size_t i = 0;
+        while (true) {
+            size_t first = D * i + 1;
+            if (first >= n) break;
+            size_t end = first + D < n ? first + D : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < end; c++) {
+                if (less_(at(c), at(best))) best = c;
+            }
+            if (!less_(at(best), last)) break;
+            at(i) = at(best);
+            i = best;
+        }
+        at(i) = last;
+    }
+
+private:
+    T& at(size_t i) { return items_[i + OFFSET]; }
+    const T& at(size_t i) const { return items_[i + OFFSET]; }
+
+    Less less_;
+    std::vector<T, AlignedAllocator<T, 64>> items_;
+};
+
+// Pairing heap with nodes in a pooled vector (indices instead of pointers);
+// pop uses the standard two-pass pairing of the root's children
+template<typename T, typename Less>
+class PairingHeap {
+public:
+    explicit PairingHeap(Less less = Less()) : less_(less) {}
+
+    void reserve(size_t n) { nodes_.reserve(n); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T& top() const { return nodes_[root_].value; }
+
+    void push(const T& value) {
+        int32_t node;
+        if (free_ >= 0) {
+            node = free_;
+            free_ = nodes_[node].sibling;
+            nodes_[node] = {value, -1, -1};
+        } else {
+            node = static_cast<int32_t>(nodes_.size());
+            nodes_.push_back({value, -1, -1});
+        }
+        root_ = root_ < 0 ? node : meld(root_, node);
+        size_++;
+    }
+
+    void pop() {
+        int32_t old = root_;
+        int32_t child = nodes_[old].child;
+        nodes_[old].sibling = free_;
+        free_ = old;
+        size_--;
+
+        // First pass: meld children pairwise left to right, chaining the results
+        int32_t pairs = -1;
+        while (child >= 0) {
+            int32_t a = child, b = nodes_[a].sibling;
+            if (b < 0) {
+                nodes_[a].sibling = pairs;
+                pairs = a;
+                break;
+            }
+            child = nodes_[b].sibling;
+            nodes_[a].sibling = nodes_[b].sibling = -1;
+            int32_t merged = meld(a, b);
+            nodes_[merged].sibling = pairs;
+            pairs = merged;
+        }
+
+        // Second pass: meld the chain right to left into a single tree
+        root_ = -1;
+        while (pairs >= 0) {
+            int32_t next = nodes_[pairs].sibling;
+            nodes_[pairs].sibling = -1;
+            root_ = root_ < 0 ? pairs : meld(root_, pairs);
+            pairs = next;
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        int32_t child, sibling;
+    };
+
+    // Makes the larger root the leftmost child of the smaller; returns the new root
+    int32_t meld(int32_t a, int32_t b) {
+        if (less_(nodes_[b].value, nodes_[a].value)) std::swap(a, b);
+        nodes_[b].sibling = nodes_[a].child;
+        nodes_[a].child = b;
+        return a;
+    }
+
+    Less less_;
+    std::vector<Node> nodes_;
+    int32_t root_ = -1, free_ = -1;
+    size_t size_ = 0;
+};
@@ -5,9 +5,65 @@
 #include <random>
 #include <algorithm>
 #include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
 
 #ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Keep windows.h from defining min and max macros over std::min/std::max
+#endif
 #include <windows.h>
+#include <malloc.h>
+#else
+#include <alloca.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "app_caches.h"
+#include "bplus_tree.h"
+#include "cache_oblivious.h"
+#include "cache_topology.h"
+#include "column_scan.h"
+#include "filters.h"
+#include "gather.h"
+#include "heaps.h"
+#include "memory_profile.h"
+#include "pattern_classifier.h"
+#include "perf_counters.h"
+#include "perf_sampling.h"
+#include "resctrl.h"
+#include "reuse_distance.h"
+#include "sort_algorithms.h"
+#include "stride_model.h"
+#include "topdown.h"
+#include "uncore_imc.h"
+#include "varlen_records.h"
+
+#ifdef _WIN32
 // Windows high-resolution timer
 double get_time() {
     LARGE_INTEGER frequency, counter;
@@ -23,10 +79,191 @@ double get_time() {
 }
 #endif
 
+#ifdef _WIN32
+bool pin_current_thread(int core) {
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+}
+#elif defined(__linux__)
+bool pin_current_thread(int core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0; // 0 = calling thread
+}
+#else
+bool pin_current_thread(int) { return false; } // No affinity API (e.g. macOS)
+#endif
+
+#ifdef __linux__
+// Hardware threads sharing `core`'s physical core, `core` included; empty when unknown
+std::vector<int> thread_siblings(int core) {
+    std::ifstream f("/sys/devices/system/cpu/cpu" + std::to_string(core) + "/topology/thread_siblings_list");
+    std::string list;
+    std::vector<int> cpus;
+    if (!(f >> list)) return cpus;
+    
+    // Format is a comma-separated list of CPUs and ranges, e.g. "0,64" or "0-1"
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t dash = item.find('-');
+        int lo = std::stoi(item.substr(0, dash));
+        int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+        for (int cpu = lo; cpu <= hi; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// Another hardware thread on the same physical core, or -1 when SMT is off/unknown
+int smt_sibling(int core) {
+    for (int cpu : thread_siblings(core)) {
+        if (cpu != core) return cpu;
+    }
+    return -1;
+}
+
+// Lowest-numbered CPU on a different physical core than `core`, or -1 if none
+int other_physical_core(int core) {
+    std::vector<int> siblings = thread_siblings(core);
+    if (siblings.empty()) siblings.push_back(core);
+    for (int cpu = 0; cpu < static_cast<int>(std::thread::hardware_concurrency()); cpu++) {
+        if (std::find(siblings.begin(), siblings.end(), cpu) == siblings.end()) return cpu;
+    }
+    return -1;
+}
+#else
+int smt_sibling(int) { return -1; }
+// Without topology information assume no SMT
+int other_physical_core(int core) { return std::thread::hardware_concurrency() > 1 ? (core == 0 ? 1 : 0) : -1; }
+#endif
+
+// Value following `flag` on the command line, or `fallback` when absent
+std::string arg_value(int argc, char* argv[], const std::string& flag, const std::string& fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (flag == argv[i]) return argv[i + 1];
+    }
+    return fallback;
+}
+
+// Profile for another mode's --profile option: applied only when it was
+// calibrated on this machine, otherwise the mode falls back to its own tuning
+bool load_memory_profile_for_mode(const std::string& path, MemoryProfile& profile) {
+    std::string error;
+    ProfileStatus status = load_memory_profile(path, profile, error);
+    if (status != ProfileStatus::Ok) {
+        std::cerr << "Warning: ignoring profile: " << error
+                  << (status == ProfileStatus::Unusable ? "" : "; re-run calibrate") << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Reads an address trace: one address per line, decimal or 0x-prefixed hex,
+// blank lines and # comments skipped; false (with `error`) when unreadable
+bool read_address_trace(const std::string& path, std::vector<uint64_t>& addresses, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); number++) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        try {
+            addresses.push_back(std::stoull(line, nullptr, 0));
+        } catch (const std::exception&) {
+            error = path + ":" + std::to_string(number) + ": not an address";
+            return false;
+        }
+    }
+    if (addresses.empty()) error = path + " has no addresses";
+    return !addresses.empty();
+}
+
 struct DataStruct {
     uint32_t a, b, c, d, e, f, g, h;
 };
 
+// Compact sort record: key plus position of the full record in arr
+struct KeyIndex {
+    uint32_t key, index;
+};
+
+struct KeyIndexLess {
+    bool operator()(const KeyIndex& x, const KeyIndex& y) const { return x.key < y.key; }
+};
+
+// STREAM-style triad (a = b + s*c), used as a pure bandwidth workload
+struct StreamArrays {
+    std::vector<double> a, b, c;
+    
+    explicit StreamArrays(size_t n) : a(n, 0.0), b(n, 1.0), c(n, 2.0) {}
+    
+    void triad(double scalar) {
+        for (size_t i = 0; i < a.size(); i++) {
+            a[i] = b[i] + scalar * c[i];
+        }
+    }
+};
+
+// Placement benchmark storage: up to 1 MiB of records plus one uint32_t index
+// per record
+constexpr size_t PLACEMENT_MAX_BYTES = (1 << 20) / sizeof(DataStruct) * (sizeof(DataStruct) + sizeof(uint32_t));
+alignas(64) static unsigned char placement_static[PLACEMENT_MAX_BYTES];
+
+// The thread_local copy lives in every thread's static TLS block, which is
+// reserved and zeroed whenever any mode creates a thread, so it is capped at
+// 64 KiB of records; larger working sets skip the thread_local region
+constexpr size_t PLACEMENT_TLS_BYTES = (64 << 10) / sizeof(DataStruct) * (sizeof(DataStruct) + sizeof(uint32_t));
+alignas(64) static thread_local unsigned char placement_thread_local[PLACEMENT_TLS_BYTES];
+
+// Largest stack buffer the placement benchmark allocates: half the stack limit
+size_t placement_stack_limit() {
+#ifdef _WIN32
+    return 512 * 1024; // Default stack reserve is 1 MiB
+#else
+    rlimit limit;
+    if (getrlimit(RLIMIT_STACK, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) return PLACEMENT_MAX_BYTES;
+    return static_cast<size_t>(limit.rlim_cur) / 2;
+#endif
+}
+
+// Calls body(buffer) with a 64-byte aligned buffer of `bytes` in this frame
+template<typename Body>
+void with_stack_buffer(size_t bytes, Body body) {
+#ifdef _WIN32
+    unsigned char* raw = static_cast<unsigned char*>(_alloca(bytes + 64));
+#else
+    unsigned char* raw = static_cast<unsigned char*>(alloca(bytes + 64));
+#endif
+    body(raw + (64 - reinterpret_cast<uintptr_t>(raw) % 64) % 64);
+}
+
+inline size_t page_offset(const void* p) { return reinterpret_cast<uintptr_t>(p) % 4096; }
+
+// Resizes `storage` to `count` elements plus a page of slack and returns the
+// element whose address minus `anchor` is `offset` modulo 4096 (offset and
+// the anchor's alignment must be multiples of sizeof(T))
+template<typename T>
+T* place_at_page_offset(std::vector<T>& storage, size_t count, const void* anchor, size_t offset) {
+    storage.assign(count + 4096 / sizeof(T), T());
+    size_t shift = (page_offset(anchor) + offset + 4096 - page_offset(storage.data())) % 4096 / sizeof(T);
+    return storage.data() + shift;
+}
+
+// Pins `value` to a register at this point without emitting code, so the
+// compiler neither vectorizes the surrounding loop nor if-converts a branch
+// containing it into a conditional move
+template<typename T>
+inline void keep_in_register(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+r"(value));
+#else
+    (void)value;
+#endif
+}
+
 class MemoryBenchmark {
 private:
     static constexpr size_t ARRAY_SIZE = 4 * 1024 * 1024; // 128 MiB
@@ -92,35 +329,109 @@ public:
         }
     }
     
-    template<typename GenerateFunc>
-    double benchmarkPattern(GenerateFunc generate, const std::string& patternName) {
-        generate();
-        
-        std::vector<double> times(NUM_ITERATIONS);
+    // Clusters of 16 consecutive slots (one 4 KiB page of records) in random
+    // order, visited in order within each cluster
+    void generateClusteredIndices() {
+        const size_t cluster = 16;
+        std::vector<size_t> starts;
+        for (size_t s = 0; s < indices.size(); s += cluster) starts.push_back(s);
+        std::shuffle(starts.begin(), starts.end(), rng);
+        size_t i = 0;
+        for (size_t start : starts) {
+            for (size_t s = start; s < std::min(start + cluster, indices.size()); s++) indices[i++] = s * 8;
+        }
+    }
+    
+    // Zipf(s) over the same slots: rank r is drawn with probability ~ 1/(r+1)^s,
+    // and ranks are scattered over the array by an odd multiplier
+    void generateZipfIndices(double s) {
+        size_t n = indices.size();
+        std::vector<double> cdf(n);
+        double total = 0.0;
+        for (size_t r = 0; r < n; r++) {
+            total += 1.0 / std::pow(static_cast<double>(r + 1), s);
+            cdf[r] = total;
+        }
+        std::uniform_real_distribution<double> uniform(0.0, total);
+        for (size_t i = 0; i < n; i++) {
+            size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+            indices[i] = ((std::min(rank, n - 1) * 0x9e3779b1ULL) & (n - 1)) * 8; // n is a power of two
+        }
+    }
+    
+    static const std::vector<std::string>& patternNames() {
+        static const std::vector<std::string> names = {
+            "Sequential", "Backward", "Interleaved", "Bouncing", "Random"
+        };
+        return names;
+    }
+    
+    // Every name generateNamedIndices accepts: the five suite patterns plus Clustered
+    static const std::vector<std::string>& namedPatterns() {
+        static const std::vector<std::string> names = [] {
+            std::vector<std::string> all = patternNames();
+            all.push_back("Clustered");
+            return all;
+        }();
+        return names;
+    }
+    
+    bool generateNamedIndices(const std::string& name) {
+        if (name == "Sequential") generateSequentialIndices();
+        else if (name == "Backward") generateBackwardIndices();
+        else if (name == "Interleaved") generateInterleavedIndices();
+        else if (name == "Bouncing") generateBouncingIndices();
+        else if (name == "Random") generateRandomIndices();
+        else if (name == "Clustered") generateClusteredIndices();
+        else return false;
+        return true;
+    }
+    
+    // Runs `pass` warmup + iterations times; returns sorted per-iteration times in ms
+    template<typename PassFunc>
+    static std::vector<double> timePasses(PassFunc pass, int iterations, int warmup) {
+        std::vector<double> times(iterations);
         
         // Warmup runs
-        for (int w = 0; w < WARMUP_ITERATIONS; w++) {
-            volatile uint64_t sum = 0;
-            for (size_t j = 0; j < indices.size(); j++) {
-                sum += arr[indices[j]].a;
-            }
+        for (int w = 0; w < warmup; w++) {
+            pass();
         }
         
         // Benchmark runs
-        for (int i = 0; i < NUM_ITERATIONS; i++) {
+        for (int i = 0; i < iterations; i++) {
             double start = get_time();
-            
-            volatile uint64_t sum = 0;
-            for (size_t j = 0; j < indices.size(); j++) {
-                sum += arr[indices[j]].a;
-            }
-            
+            pass();
             double end = get_time();
             times[i] = (end - start) * 1000.0; // Convert to ms
         }
         
-        // Calculate median time
         std::sort(times.begin(), times.end());
+        return times;
+    }
+    
+    // The sum stays in a register and is stored once, so the timed loop has
+    // no per-access stack store to alias with the loads
+    static void gatherPass(const std::vector<DataStruct>& data, const std::vector<size_t>& idx) {
+        uint64_t sum = 0;
+        for (size_t j = 0; j < idx.size(); j++) {
+            sum += data[idx[j]].a;
+            keep_in_register(sum);
+        }
+        volatile uint64_t sink = sum;
+        (void)sink;
+    }
+    
+    // Times the gather loop over the current indices; returns sorted times in ms
+    std::vector<double> timeCurrentIndices(int iterations, int warmup) {
+        return timePasses([this]() { gatherPass(arr, indices); }, iterations, warmup);
+    }
+    
+    template<typename GenerateFunc>
+    double benchmarkPattern(GenerateFunc generate, const std::string& patternName) {
+        generate();
+        
+        // Calculate median time
+        std::vector<double> times = timeCurrentIndices(NUM_ITERATIONS, WARMUP_ITERATIONS);
         double median_time = times[NUM_ITERATIONS / 2];
         
         std::cout << std::setw(12) << patternName << ": " 
@@ -154,10 +465,2980 @@ public:
         std::cout << "Bouncing," << bouncing << std::endl;
         std::cout << "Random," << random << std::endl;
     }
-};
-
-int main() {
-    MemoryBenchmark benchmark;
-    benchmark.runBenchmarks();
-    return 0;
+    
+    // Pairwise co-location matrix: each workload is timed on `victimCore`, alone
+    // and while every other workload loops on `aggressorCore`
+    void runInterference(int victimCore, int aggressorCore) {
+        std::vector<std::string> workloads = patternNames();
+        workloads.push_back("STREAM");
+        
+        // The aggressor gets private buffers so only shared caches and memory
+        // bandwidth are contended, not the data itself
+        std::vector<DataStruct> aggressorArr(arr);
+        std::vector<size_t> aggressorIndices(indices.size());
+        StreamArrays victimStream(ARRAY_SIZE), aggressorStream(ARRAY_SIZE);
+        
+        std::cout << "Interference Benchmark (C++)" << std::endl;
+        std::cout << "Victim core " << victimCore << ", aggressor core " << aggressorCore
+                  << (aggressorCore == smt_sibling(victimCore) ? " (SMT sibling)" : "") << std::endl;
+        if (std::thread::hardware_concurrency() < 2 || aggressorCore == victimCore) {
+            std::cout << "Warning: victim and aggressor share one hardware thread; "
+                      << "slowdowns reflect time-slicing, not cache/bandwidth contention" << std::endl;
+        }
+        std::cout << "Slowdown = co-run median / solo median (rows: victim, columns: aggressor)\n" << std::endl;
+        
+        size_t n = workloads.size();
+        std::vector<std::vector<double>> corun(n, std::vector<double>(n));
+        std::vector<double> soloTimes(n);
+        
+        if (!pin_current_thread(victimCore)) {
+            std::cerr << "Warning: could not pin victim to core " << victimCore << std::endl;
+        }
+        
+        for (size_t v = 0; v < n; v++) {
+            bool victimStreams = workloads[v] == "STREAM";
+            auto victimPass = [&]() {
+                if (victimStreams) victimStream.triad(3.0);
+                else gatherPass(arr, indices);
+            };
+            
+            if (!victimStreams) generateNamedIndices(workloads[v]);
+            soloTimes[v] = timePasses(victimPass, NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2];
+            
+            for (size_t a = 0; a < n; a++) {
+                bool aggressorStreams = workloads[a] == "STREAM";
+                if (!aggressorStreams) {
+                    generateNamedIndices(workloads[a]);
+                    aggressorIndices = indices;
+                    if (!victimStreams) generateNamedIndices(workloads[v]);
+                }
+                
+                std::atomic<bool> stop{false}, started{false};
+                std::thread aggressor([&]() {
+                    pin_current_thread(aggressorCore);
+                    started = true;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        if (aggressorStreams) aggressorStream.triad(3.0);
+                        else gatherPass(aggressorArr, aggressorIndices);
+                    }
+                });
+                while (!started) std::this_thread::yield();
+                
+                corun[v][a] = timePasses(victimPass, NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2];
+                stop = true;
+                aggressor.join();
+            }
+        }
+        
+        std::cout << std::setw(12) << "" << " ";
+        for (const auto& name : workloads) std::cout << std::setw(12) << name;
+        std::cout << std::endl;
+        for (size_t v = 0; v < n; v++) {
+            std::cout << std::setw(12) << workloads[v] << ":";
+            for (size_t a = 0; a < n; a++) {
+                std::cout << std::setw(11) << std::fixed << std::setprecision(2)
+                          << corun[v][a] / soloTimes[v] << "x";
+            }
+            std::cout << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Victim,Aggressor,Solo_ms,Corun_ms,Slowdown" << std::endl;
+        for (size_t v = 0; v < n; v++) {
+            for (size_t a = 0; a < n; a++) {
+                std::cout << workloads[v] << "," << workloads[a] << ","
+                          << soloTimes[v] << "," << corun[v][a] << ","
+                          << std::setprecision(3) << corun[v][a] / soloTimes[v]
+                          << std::setprecision(2) << std::endl;
+            }
+        }
+    }
+    
+    // Times every pattern with the current thread's resctrl allocation
+    std::vector<double> timeAllPatterns() {
+        std::vector<double> medians;
+        for (const auto& name : patternNames()) {
+            generateNamedIndices(name);
+            medians.push_back(timeCurrentIndices(NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2]);
+        }
+        return medians;
+    }
+    
+#ifdef __linux__
+    // Sweeps L3 way masks and MBA throttling for a resctrl group holding the
+    // measuring thread; sensitivity = time under restriction / unrestricted time
+    int runResctrlSweep(int core) {
+        std::cout << "Resctrl Partitioning Benchmark (C++)" << std::endl;
+        if (!ResctrlGroup::available()) {
+            std::cout << "resctrl is not mounted at " << ResctrlGroup::ROOT << "; skipping" << std::endl;
+            return 0;
+        }
+        
+        ResctrlGroup::Resource l3, mb;
+        bool hasL3 = ResctrlGroup::readResource("L3", l3);
+        bool hasMB = ResctrlGroup::readResource("MB", mb);
+        if (!hasL3 && !hasMB) {
+            std::cout << "No L3 or MB resource in resctrl (CDP-only or monitoring-only system); skipping" << std::endl;
+            return 0;
+        }
+        
+        ResctrlGroup group("membench_" + std::to_string(static_cast<long>(getpid())));
+        if (!group.ok()) {
+            std::cout << "Cannot use resctrl: " << group.error() << "; skipping" << std::endl;
+            return 0;
+        }
+        pin_current_thread(core);
+        if (!group.addCurrentThread()) {
+            std::cerr << "Failed to join resctrl group: " << group.error() << std::endl;
+            return 1;
+        }
+        
+        struct Row { std::string resource, setting; std::vector<double> times; };
+        std::vector<Row> rows;
+        auto measure = [&](const std::string& resource, const std::string& setting) {
+            rows.push_back({resource, setting, timeAllPatterns()});
+            std::cout << std::setw(4) << resource << " " << std::setw(10) << setting << ":";
+            for (double t : rows.back().times) {
+                std::cout << std::setw(12) << std::fixed << std::setprecision(2) << t;
+            }
+            std::cout << std::endl;
+        };
+        
+        std::cout << std::setw(16) << "" << ":";
+        for (const auto& name : patternNames()) std::cout << std::setw(12) << name;
+        std::cout << "  (ms)" << std::endl;
+        
+        if (hasL3) group.setL3Mask(l3, l3.fullValue);
+        if (hasMB) group.setMemBandwidth(mb, mb.fullValue);
+        measure("none", "baseline");
+        
+        if (hasL3) {
+            // Intel requires contiguous masks, so sweep low-order runs of ways
+            int ways = 0;
+            for (uint32_t m = l3.fullValue; m; m >>= 1) ways += m & 1;
+            int minWays = static_cast<int>(ResctrlGroup::readInfo("L3/min_cbm_bits", 1));
+            for (int w = ways; w >= minWays; w--) {
+                uint32_t mask = (w >= 32 ? 0xffffffffu : (1u << w) - 1) << __builtin_ctz(l3.fullValue);
+                if (!group.setL3Mask(l3, mask)) {
+                    std::cerr << group.error() << std::endl;
+                    break;
+                }
+                measure("L3", std::to_string(w) + " ways");
+            }
+            group.setL3Mask(l3, l3.fullValue);
+        }
+        
+        if (hasMB) {
+            // Intel MBA takes percentages, AMD absolute units; step in tenths of the maximum
+            uint32_t gran = std::max<uint32_t>(1, ResctrlGroup::readInfo("MB/bandwidth_gran", 1));
+            uint32_t minBw = std::max<uint32_t>(1, ResctrlGroup::readInfo("MB/min_bandwidth", 1));
+            for (int tenth = 10; tenth >= 1; tenth--) {
+                uint32_t value = mb.fullValue * tenth / 10 / gran * gran;
+                if (value < minBw) break;
+                if (!group.setMemBandwidth(mb, value)) {
+                    std::cerr << group.error() << std::endl;
+                    break;
+                }
+                measure("MB", std::to_string(tenth * 10) + "%");
+            }
+            group.setMemBandwidth(mb, mb.fullValue);
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Resource,Setting,Pattern,Time_ms,Sensitivity" << std::endl;
+        for (const auto& row : rows) {
+            for (size_t p = 0; p < patternNames().size(); p++) {
+                std::cout << row.resource << "," << row.setting << "," << patternNames()[p] << ","
+                          << std::setprecision(2) << row.times[p] << ","
+                          << std::setprecision(3) << row.times[p] / rows[0].times[p] << std::endl;
+            }
+        }
+        return 0;
+    }
+#endif
+    
+    // Cache-oblivious recursive kernels vs blocked versions tuned from the
+    // detected cache sizes, across working sets from L1 to arr-sized
+    void runObliviousSuite(const MemoryProfile* profile) {
+        CacheTopology topo = detect_cache_topology();
+        
+        // Largest power-of-two tiles whose working tiles fit the target level
+        auto pow2Tile = [](size_t bytes, size_t tiles) {
+            size_t t = 8;
+            while (tiles * (2 * t) * (2 * t) * sizeof(uint32_t) <= bytes) t *= 2;
+            return t;
+        };
+        // Transpose writes one line per tile row; with power-of-two n those lines
+        // share L1 sets, so tiles wider than a cache line cause conflict misses
+        size_t transposeTile = std::min(pow2Tile(topo.l1d, 2), topo.lineSize / sizeof(uint32_t));
+        size_t matmulTile = pow2Tile(topo.l2 / 2, 3);   // Three operand tiles in half of L2
+        size_t sortRun = topo.l2 / (2 * sizeof(uint32_t)); // Run plus merge buffer in L2
+        if (profile) {
+            transposeTile = profile->transposeTile;
+            matmulTile = profile->matmulTile;
+        }
+        
+        PerfCounters counters;
+        bool haveLlc = counters.add("LLC-misses", PerfCounters::TYPE_HARDWARE, PerfCounters::HW_CACHE_MISSES);
+        
+        std::cout << "Cache-Oblivious vs Blocked Benchmark (C++)" << std::endl;
+        std::cout << "Detected L1d " << topo.l1d / 1024 << " KiB, L2 " << topo.l2 / 1024
+                  << " KiB, L3 " << topo.l3 / 1024 << " KiB" << std::endl;
+        std::cout << "Tiles" << (profile ? " (from profile)" : "") << ": transpose " << transposeTile
+                  << ", matmul " << matmulTile << ", sort run " << sortRun << " keys" << std::endl;
+        std::cout << "ns/element is per output element (transpose, sort) or per multiply-add (matmul)"
+                  << (haveLlc ? "" : "; LLC misses unavailable on this system") << "\n" << std::endl;
+        
+        struct Row { std::string kernel, variant; size_t size, workingSetKiB; double nsPerElement, llcPerElement; };
+        std::vector<Row> rows;
+        
+        // Times `pass` (which processes `elements` units) and records one row
+        auto record = [&](const std::string& kernel, const std::string& variant, size_t size,
+                          size_t workingSetBytes, double elements, auto pass) {
+            const int iterations = 5, warmup = 1;
+            // Repeat small problems so each timed pass is long enough to resolve
+            int reps = static_cast<int>(std::max(1.0, (1 << 22) / elements));
+            auto repeated = [&]() { for (int r = 0; r < reps; r++) pass(); };
+            counters.start();
+            std::vector<double> times = timePasses(repeated, iterations, warmup);
+            counters.stop();
+            double total = elements * reps;
+            rows.push_back({kernel, variant, size, workingSetBytes / 1024,
+                            times[iterations / 2] * 1e6 / total,
+                            counters.value("LLC-misses") / (total * (iterations + warmup))});
+            const Row& row = rows.back();
+            std::cout << std::setw(10) << kernel << std::setw(10) << variant << std::setw(10) << size
+                      << std::setw(10) << row.workingSetKiB << " KiB"
+                      << std::setw(10) << std::fixed << std::setprecision(3) << row.nsPerElement << " ns"
+                      << std::setw(10);
+            if (std::isnan(row.llcPerElement)) std::cout << "n/a";
+            else std::cout << std::setprecision(4) << row.llcPerElement;
+            std::cout << " LLC/elem" << std::endl;
+        };
+        
+        for (size_t n = 64; n * n <= ARRAY_SIZE; n *= 2) {
+            std::vector<uint32_t> a(n * n), b1(n * n), b2(n * n);
+            for (size_t i = 0; i < n * n; i++) a[i] = arr[i].a;
+            double elems = static_cast<double>(n * n);
+            record("transpose", "oblivious", n, 2 * n * n * sizeof(uint32_t), elems,
+                   [&]() { transpose_oblivious(a.data(), b1.data(), n); });
+            record("transpose", "blocked", n, 2 * n * n * sizeof(uint32_t), elems,
+                   [&]() { transpose_blocked(a.data(), b2.data(), n, transposeTile); });
+            if (b1 != b2) std::cerr << "Warning: transpose results differ at n=" << n << std::endl;
+        }
+        
+        for (size_t n = 32; n <= 1024; n *= 2) {
+            std::vector<uint32_t> a(n * n), b(n * n), c1(n * n), c2(n * n);
+            for (size_t i = 0; i < n * n; i++) {
+                a[i] = arr[i].a;
+                b[i] = arr[i].b;
+            }
+            double madds = static_cast<double>(n) * n * n;
+            record("matmul", "oblivious", n, 3 * n * n * sizeof(uint32_t), madds,
+                   [&]() { matmul_oblivious(a.data(), b.data(), c1.data(), n); });
+            record("matmul", "blocked", n, 3 * n * n * sizeof(uint32_t), madds,
+                   [&]() { matmul_blocked(a.data(), b.data(), c2.data(), n, matmulTile); });
+            if (c1 != c2) std::cerr << "Warning: matmul results differ at n=" << n << std::endl;
+        }
+        
+        for (size_t n = 4096; n <= ARRAY_SIZE; n *= 4) {
+            std::vector<uint32_t> keys(n), work, tmp, sorted1, sorted2;
+            for (size_t i = 0; i < n; i++) keys[i] = arr[i].a;
+            // The input copy is part of each pass for both variants
+            record("sort", "oblivious", n, 2 * n * sizeof(uint32_t), static_cast<double>(n),
+                   [&]() { work = keys; merge_sort_oblivious(work, tmp); });
+            sorted1 = work;
+            record("sort", "blocked", n, 2 * n * sizeof(uint32_t), static_cast<double>(n),
+                   [&]() { work = keys; merge_sort_blocked(work, tmp, sortRun); });
+            sorted2 = work;
+            if (sorted1 != sorted2) std::cerr << "Warning: sort results differ at n=" << n << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Kernel,Variant,Size,WorkingSet_KiB,Ns_per_element,LLC_misses_per_element" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.kernel << "," << row.variant << "," << row.size << "," << row.workingSetKiB << ","
+                      << std::setprecision(4) << row.nsPerElement << ","
+                      << std::setprecision(5) << row.llcPerElement << std::endl;
+        }
+    }
+    
+    // Filter probe benchmark: each filter gets the same key set and the Bloom
+    // variants the same byte budget (cuckoo twice it), sized from L2 to beyond
+    // LLC, and is probed with an even mix of inserted keys (picked by the
+    // Random pattern) and fresh keys (for false positives)
+    void runFilterSuite(size_t maxBytes) {
+        CacheTopology topo = detect_cache_topology();
+        const double bitsPerKey = 10.0;
+        
+        std::cout << "Filter Probe Benchmark (C++)" << std::endl;
+        std::cout << "L2 " << topo.l2 / 1024 << " KiB, L3 " << topo.l3 / 1024 << " KiB; "
+                  << bitsPerKey << " bits/key, " << indices.size() << " lookups per pass"
+#ifdef __AVX2__
+                  << ", AVX2 register blocks"
+#else
+                  << ", scalar register blocks (build with -mavx2 for SIMD)"
+#endif
+                  << "\n" << std::endl;
+        
+        struct Row { std::string filter; size_t kib, keys; double mlookups, fpr; size_t failures; };
+        std::vector<Row> rows;
+        std::uniform_int_distribution<uint64_t> keyDist;
+        
+        for (size_t bytes = floor_pow2(topo.l2); bytes <= maxBytes; bytes *= 4) {
+            size_t n = static_cast<size_t>(bytes * 8 / bitsPerKey);
+            std::vector<uint64_t> keys(n);
+            for (auto& key : keys) key = keyDist(rng);
+            
+            // Even positions probe inserted keys chosen by the Random pattern, odd ones fresh keys
+            generateRandomIndices();
+            std::vector<uint64_t> queries(indices.size());
+            for (size_t j = 0; j < queries.size(); j++) {
+                queries[j] = j % 2 == 0 ? keys[(indices[j] / 8) % n] : keyDist(rng);
+            }
+            
+            BloomFilter classic(bytes, 7);
+            BlockedBloomFilter blocked(bytes, 7);
+            RegisterBlockedBloomFilter registerBlocked(bytes);
+            CuckooFilter cuckoo(2 * bytes); // 16-bit fingerprints need ~17 bits/key at 95% load
+            size_t cuckooFailures = 0;
+            for (uint64_t key : keys) {
+                classic.insert(key);
+                blocked.insert(key);
+                registerBlocked.insert(key);
+                cuckooFailures += !cuckoo.insert(key);
+            }
+            
+            auto measure = [&](const std::string& name, auto& filter, size_t failures) {
+                size_t falsePositives = 0, misses = 0;
+                for (size_t j = 0; j < queries.size(); j++) {
+                    bool hit = filter.contains(queries[j]);
+                    if (j % 2 == 0) misses += !hit;
+                    else falsePositives += hit;
+                }
+                if (misses > failures) {
+                    std::cerr << "Warning: " << name << " missed " << misses << " inserted keys" << std::endl;
+                }
+                
+                std::vector<double> times = timePasses([&]() {
+                    size_t found = 0;
+                    for (uint64_t q : queries) {
+                        found += filter.contains(q);
+                        keep_in_register(found);
+                    }
+                    volatile size_t sink = found;
+                    (void)sink;
+                }, NUM_ITERATIONS, WARMUP_ITERATIONS);
+                double median_time = times[NUM_ITERATIONS / 2];
+                rows.push_back({name, filter.bytes() / 1024, n, queries.size() / (median_time * 1e3),
+                                100.0 * falsePositives / (queries.size() / 2), failures});
+                std::cout << std::setw(18) << name << std::setw(10) << rows.back().kib << " KiB: "
+                          << std::setw(8) << std::fixed << std::setprecision(2) << rows.back().mlookups << " M lookups/s"
+                          << std::setw(9) << std::setprecision(3) << rows.back().fpr << "% FPR";
+                if (failures) std::cout << "  (" << failures << " insert failures)";
+                std::cout << std::endl;
+            };
+            
+            measure("Bloom", classic, 0);
+            measure("Blocked Bloom", blocked, 0);
+            measure("Register Bloom", registerBlocked, 0);
+            measure("Cuckoo", cuckoo, cuckooFailures);
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Filter,Size_KiB,Keys,MLookups_per_s,FPR_percent,Insert_failures" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.filter << "," << row.kib << "," << row.keys << ","
+                      << std::setprecision(2) << row.mlookups << "," << std::setprecision(4) << row.fpr << ","
+                      << row.failures << std::endl;
+        }
+    }
+    
+    // Heap layout benchmark: each heap is filled with n (arr[i].a, i) entries, then
+    // driven with the hold model of timer queues (pop the minimum, push it back
+    // later by a random delay from arr) so the size stays at n
+    template<typename Heap>
+    bool heapSelfCheck() {
+        Heap heap;
+        for (size_t i = 0; i < 2000; i++) heap.push({arr[i].a, static_cast<uint32_t>(i)});
+        uint32_t previous = 0;
+        for (size_t i = 0; i < 2000; i++) {
+            if (heap.top().key < previous) return false;
+            previous = heap.top().key;
+            heap.pop();
+        }
+        return heap.empty();
+    }
+    
+    void runHeapSuite(size_t maxElements) {
+        const size_t holdsPerPass = indices.size() / 2;
+        PerfCounters counters;
+        bool haveLlc = counters.add("LLC-misses", PerfCounters::TYPE_HARDWARE, PerfCounters::HW_CACHE_MISSES);
+        bool haveL1 = counters.add("L1D-misses", PerfCounters::TYPE_HW_CACHE, PerfCounters::HW_CACHE_L1D_READ_MISS);
+        
+        std::cout << "Heap Layout Benchmark (C++)" << std::endl;
+        std::cout << holdsPerPass << " pop+push pairs per pass; ns/op is per push or pop"
+                  << (haveLlc || haveL1 ? "" : "; cache-miss counters unavailable on this system") << "\n" << std::endl;
+        
+        struct Row { std::string heap; size_t elements, kib; double nsPerOp, llcPerOp, l1PerOp; };
+        std::vector<Row> rows;
+        
+        auto run = [&](const std::string& name, auto heap, size_t nodeBytes, bool selfCheck, size_t n) {
+            if (!selfCheck) std::cerr << "Warning: " << name << " failed its ordering self-check" << std::endl;
+            heap.reserve(n);
+            for (size_t i = 0; i < n; i++) heap.push({arr[i].a, static_cast<uint32_t>(i)});
+            
+            size_t cursor = 0;
+            auto holdPass = [&]() {
+                for (size_t op = 0; op < holdsPerPass; op++) {
+                    KeyIndex next = heap.top();
+                    heap.pop();
+                    next.key += arr[cursor].b >> 8; // Random delay, up to 2^24
+                    cursor = (cursor + 1) & (ARRAY_SIZE - 1);
+                    heap.push(next);
+                }
+            };
+            
+            counters.start();
+            std::vector<double> times = timePasses(holdPass, NUM_ITERATIONS, WARMUP_ITERATIONS);
+            counters.stop();
+            double ops = 2.0 * holdsPerPass;
+            double countedOps = ops * (NUM_ITERATIONS + WARMUP_ITERATIONS);
+            rows.push_back({name, n, n * nodeBytes / 1024, times[NUM_ITERATIONS / 2] * 1e6 / ops,
+                            counters.value("LLC-misses") / countedOps, counters.value("L1D-misses") / countedOps});
+            
+            const Row& row = rows.back();
+            std::cout << std::setw(14) << name << std::setw(10) << n << std::setw(9) << row.kib << " KiB: "
+                      << std::setw(8) << std::fixed << std::setprecision(2) << row.nsPerOp << " ns/op";
+            if (haveLlc) std::cout << std::setw(8) << std::setprecision(3) << row.llcPerOp << " LLC/op";
+            if (haveL1) std::cout << std::setw(8) << std::setprecision(3) << row.l1PerOp << " L1D/op";
+            std::cout << std::endl;
+        };
+        
+        using Binary = DaryHeap<KeyIndex, 2, false, KeyIndexLess>;
+        using FourAry = DaryHeap<KeyIndex, 4, false, KeyIndexLess>;
+        using EightAry = DaryHeap<KeyIndex, 8, false, KeyIndexLess>;
+        using AlignedEightAry = DaryHeap<KeyIndex, 8, true, KeyIndexLess>;
+        using Pairing = PairingHeap<KeyIndex, KeyIndexLess>;
+        
+        for (size_t n = 1024; n <= std::min(maxElements, arr.size()); n *= 4) {
+            run("binary", Binary(), sizeof(KeyIndex), heapSelfCheck<Binary>(), n);
+            run("4-ary", FourAry(), sizeof(KeyIndex), heapSelfCheck<FourAry>(), n);
+            run("8-ary", EightAry(), sizeof(KeyIndex), heapSelfCheck<EightAry>(), n);
+            run("8-ary aligned", AlignedEightAry(), sizeof(KeyIndex), heapSelfCheck<AlignedEightAry>(), n);
+            run("pairing", Pairing(), sizeof(KeyIndex) + 2 * sizeof(int32_t), heapSelfCheck<Pairing>(), n);
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Heap,Elements,Heap_KiB,Ns_per_op,LLC_misses_per_op,L1D_misses_per_op" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.heap << "," << row.elements << "," << row.kib << ","
+                      << std::setprecision(3) << row.nsPerOp << "," << std::setprecision(4)
+                      << row.llcPerOp << "," << row.l1PerOp << std::endl;
+        }
+    }
+    
+    struct BTreeRow { size_t nodeBytes, keys, treeKiB; int height; std::string workload; double mops; };
+    
+    // Point lookups follow the Random pattern and range scans start at keys
+    // taken in Sequential-pattern order, over trees of NODE_BYTES nodes
+    template<size_t NODE_BYTES>
+    void runBTreeNodeSize(const std::vector<uint32_t>& sortedKeys, std::vector<BTreeRow>& rows) {
+        const size_t lookups = indices.size() / 4, scanLength = 64, scans = lookups / scanLength;
+        const int iterations = 5, warmup = 1;
+        size_t n = sortedKeys.size();
+        std::vector<uint32_t> values(n);
+        for (size_t i = 0; i < n; i++) values[i] = static_cast<uint32_t>(i);
+        BPlusTree<NODE_BYTES> tree(sortedKeys, values);
+        
+        auto record = [&](const std::string& workload, double operations, auto pass) {
+            std::vector<double> times = timePasses(pass, iterations, warmup);
+            rows.push_back({NODE_BYTES, n, tree.bytes() / 1024, tree.height(), workload,
+                            operations / (times[iterations / 2] * 1e3)});
+            std::cout << std::setw(7) << NODE_BYTES << " B" << std::setw(10) << n << std::setw(9) << tree.bytes() / 1024
+                      << " KiB  h=" << tree.height() << std::setw(16) << workload << ": "
+                      << std::setw(8) << std::fixed << std::setprecision(2) << rows.back().mops << " M/s" << std::endl;
+        };
+        
+        generateRandomIndices();
+        std::vector<uint32_t> probes(lookups);
+        for (size_t j = 0; j < lookups; j++) probes[j] = sortedKeys[(indices[j] / 8) % n];
+        auto lookupPass = [&](auto find) {
+            return [&, find]() {
+                uint64_t sum = 0;
+                uint32_t value = 0;
+                for (uint32_t key : probes) {
+                    sum += find(key, value) ? value : 0;
+                    keep_in_register(sum);
+                }
+                volatile uint64_t sink = sum;
+                (void)sink;
+            };
+        };
+        record("lookup", static_cast<double>(lookups),
+               lookupPass([&](uint32_t k, uint32_t& v) { return tree.template find<false, false>(k, v); }));
+        record("lookup simd", static_cast<double>(lookups),
+               lookupPass([&](uint32_t k, uint32_t& v) { return tree.template find<true, false>(k, v); }));
+        record("lookup simd+pf", static_cast<double>(lookups),
+               lookupPass([&](uint32_t k, uint32_t& v) { return tree.template find<true, true>(k, v); }));
+        
+        generateSequentialIndices();
+        std::vector<uint32_t> starts(scans);
+        for (size_t j = 0; j < scans; j++) starts[j] = sortedKeys[(indices[j * scanLength] / 8) % n];
+        record("scan", static_cast<double>(scans * scanLength), [&]() {
+            uint64_t sum = 0;
+            for (uint32_t key : starts) {
+                sum += tree.template scan<false>(key, scanLength);
+                keep_in_register(sum);
+            }
+            volatile uint64_t sink = sum;
+            (void)sink;
+        });
+        record("scan+pf", static_cast<double>(scans * scanLength), [&]() {
+            uint64_t sum = 0;
+            for (uint32_t key : starts) {
+                sum += tree.template scan<true>(key, scanLength);
+                keep_in_register(sum);
+            }
+            volatile uint64_t sink = sum;
+            (void)sink;
+        });
+    }
+    
+    void runBTreeSuite() {
+        std::cout << "B+tree Node Size Benchmark (C++)" << std::endl;
+        std::cout << "Point lookups (Random pattern) and 64-key range scans (Sequential pattern); "
+#ifdef __AVX2__
+                  << "simd = AVX2 in-node search"
+#else
+                  << "simd = linear in-node search (build with -mavx2 for AVX2)"
+#endif
+                  << ", pf = software prefetch of children\n" << std::endl;
+        
+        std::vector<BTreeRow> rows;
+        for (size_t n = 16384; n <= ARRAY_SIZE; n *= 16) {
+            std::vector<uint32_t> keys(n);
+            for (size_t i = 0; i < n; i++) keys[i] = arr[i].a;
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            
+            runBTreeNodeSize<64>(keys, rows);
+            runBTreeNodeSize<128>(keys, rows);
+            runBTreeNodeSize<256>(keys, rows);
+            runBTreeNodeSize<512>(keys, rows);
+            runBTreeNodeSize<1024>(keys, rows);
+            runBTreeNodeSize<2048>(keys, rows);
+            runBTreeNodeSize<4096>(keys, rows);
+            runBTreeNodeSize<8192>(keys, rows);
+            runBTreeNodeSize<16384>(keys, rows);
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Node_bytes,Keys,Tree_KiB,Height,Workload,M_per_s" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.nodeBytes << "," << row.keys << "," << row.treeKiB << "," << row.height << ","
+                      << row.workload << "," << std::setprecision(2) << row.mops << std::endl;
+        }
+    }
+    
+    // Application cache benchmark: the key stream is indices / 8 (one key per
+    // 32-byte record, so the key space is indices.size()) and a miss loads the
+    // value from arr, as a cache in front of a slower store would
+    void runCacheSuite(unsigned threads, double zipfS) {
+        const size_t keySpace = indices.size();
+        const int iterations = 3, warmup = 1;
+        const size_t shards = 64;
+        // Inherited so the sharded variant's worker threads are counted as well
+        PerfCounters counters;
+        bool haveLlc = counters.add("LLC-misses", PerfCounters::TYPE_HARDWARE, PerfCounters::HW_CACHE_MISSES, true);
+        
+        std::cout << "Application Cache Benchmark (C++)" << std::endl;
+        std::cout << keySpace << " keys, " << keySpace << " lookups per pass, Zipf s = " << zipfS
+                  << ", sharded cache: " << shards << " shards, " << threads << " thread(s)"
+                  << (haveLlc ? "" : "; LLC-miss counter unavailable on this system") << "\n" << std::endl;
+        if (threads > std::thread::hardware_concurrency()) {
+            std::cerr << "Warning: more threads than hardware threads; sharded results include time-slicing" << std::endl;
+        }
+        
+        struct Row { std::string pattern, policy; size_t capacity; double hitRate, nsPerOp, bytesPerEntry, llcPerOp; };
+        std::vector<Row> rows;
+        std::vector<std::string> workloads = patternNames();
+        workloads.push_back("Zipf");
+        std::vector<uint32_t> keys(keySpace);
+        
+        auto run = [&](const std::string& pattern, const std::string& policy, size_t capacity, auto& cache,
+                       unsigned passThreads) {
+            auto load = [this](uint32_t key) { return arr[static_cast<size_t>(key) * 8].a; };
+            auto slice = [&](size_t begin, size_t end) {
+                size_t hits = 0;
+                uint32_t value = 0, sum = 0;
+                for (size_t j = begin; j < end; j++) {
+                    hits += cache.lookup(keys[j], value, load);
+                    sum += value;
+                }
+                volatile uint32_t sink = sum;
+                (void)sink;
+                return hits;
+            };
+            auto pass = [&]() {
+                if (passThreads <= 1) return slice(0, keys.size());
+                std::vector<std::thread> workers;
+                std::vector<size_t> hits(passThreads);
+                for (unsigned t = 0; t < passThreads; t++) {
+                    workers.emplace_back([&, t]() {
+                        hits[t] = slice(keys.size() * t / passThreads, keys.size() * (t + 1) / passThreads);
+                    });
+                }
+                for (auto& worker : workers) worker.join();
+                size_t total = 0;
+                for (size_t h : hits) total += h;
+                return total;
+            };
+            
+            counters.start();
+            std::vector<double> times = timePasses(pass, iterations, warmup);
+            counters.stop();
+            double hitRate = 100.0 * pass() / keys.size(); // Steady state, after the timed passes
+            double countedOps = static_cast<double>(keys.size()) * (iterations + warmup);
+            rows.push_back({pattern, policy, capacity, hitRate, times[iterations / 2] * 1e6 / keys.size(),
+                            static_cast<double>(cache.bytes()) / capacity, counters.value("LLC-misses") / countedOps});
+            
+            const Row& row = rows.back();
+            std::cout << std::setw(12) << pattern << std::setw(16) << policy << std::setw(9) << capacity << ": "
+                      << std::setw(7) << std::fixed << std::setprecision(2) << row.hitRate << "% hit"
+                      << std::setw(9) << row.nsPerOp << " ns/op" << std::setw(7) << std::setprecision(1)
+                      << row.bytesPerEntry << " B/entry";
+            if (haveLlc) std::cout << std::setw(8) << std::setprecision(3) << row.llcPerOp << " LLC/op";
+            std::cout << std::endl;
+        };
+        
+        for (const auto& pattern : workloads) {
+            if (pattern == "Zipf") generateZipfIndices(zipfS);
+            else generateNamedIndices(pattern);
+            for (size_t j = 0; j < keySpace; j++) keys[j] = static_cast<uint32_t>(indices[j] / 8);
+            
+            for (size_t capacity = keySpace / 256; capacity <= keySpace; capacity *= 4) {
+                LruCache lru(capacity);
+                run(pattern, "LRU", capacity, lru, 1);
+                ClockCache clock(capacity);
+                run(pattern, "CLOCK", capacity, clock, 1);
+                SegmentedLruCache slru(capacity);
+                run(pattern, "SLRU", capacity, slru, 1);
+                ShardedCache<LruCache> sharded(capacity, shards);
+                run(pattern, "sharded LRU x" + std::to_string(threads), capacity, sharded, threads);
+            }
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Policy,Capacity,Hit_rate_percent,Ns_per_op,Bytes_per_entry,LLC_misses_per_op" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.pattern << "," << row.policy << "," << row.capacity << ","
+                      << std::setprecision(2) << row.hitRate << "," << std::setprecision(3) << row.nsPerOp << ","
+                      << std::setprecision(1) << row.bytesPerEntry << "," << std::setprecision(4) << row.llcPerOp
+                      << std::endl;
+        }
+    }
+    
+    // Columnar scan benchmark: arr is split into SoA columns a (predicate) and b
+    // (gathered), and `a <= limit` picks the selectivity since a is uniform
+    void runScanSuite() {
+        const size_t n = arr.size();
+        const int iterations = 5, warmup = 1;
+        std::vector<uint32_t> colA(n), colB(n), sel(n + 8);
+        std::vector<uint64_t> bits((n + 63) / 64);
+        for (size_t i = 0; i < n; i++) {
+            colA[i] = arr[i].a;
+            colB[i] = arr[i].b;
+        }
+        
+        std::cout << "Columnar Scan/Filter Benchmark (C++)" << std::endl;
+        std::cout << n << " rows, filter on column a, gather column b; ns/row over all rows"
+#ifdef __AVX2__
+                  << ", AVX2 filters"
+#else
+                  << ", simd falls back to branchless (build with -mavx2 for AVX2)"
+#endif
+                  << "\n" << std::endl;
+        
+        struct Pipeline { std::string name; double filterNs, gatherNs; };
+        struct Row { double selectivity; size_t matches; std::vector<Pipeline> pipelines; };
+        std::vector<Row> rows;
+        const std::vector<double> selectivities = {0.001, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.9, 0.99, 1.0};
+        
+        auto nsPerRow = [&](auto pass) {
+            return timePasses(pass, iterations, warmup)[iterations / 2] * 1e6 / n;
+        };
+        
+        for (double selectivity : selectivities) {
+            uint32_t limit = selectivity >= 1.0 ? std::numeric_limits<uint32_t>::max()
+                                                : static_cast<uint32_t>(selectivity * 4294967296.0);
+            Row row{selectivity, 0, {}};
+            uint64_t expected = 0;
+            
+            auto selection = [&](const std::string& name, size_t (*filter)(const uint32_t*, size_t, uint32_t, uint32_t*)) {
+                size_t k = filter(colA.data(), n, limit, sel.data());
+                double filterNs = nsPerRow([&]() { volatile size_t sink = filter(colA.data(), n, limit, sel.data()); (void)sink; });
+                uint64_t sum = gather_selection(colB.data(), sel.data(), k);
+                double gatherNs = nsPerRow([&]() { volatile uint64_t sink = gather_selection(colB.data(), sel.data(), k); (void)sink; });
+                if (row.pipelines.empty()) {
+                    row.matches = k;
+                    expected = sum;
+                } else if (k != row.matches || sum != expected) {
+                    std::cerr << "Warning: " << name << " disagrees with the branchy filter" << std::endl;
+                }
+                row.pipelines.push_back({name, filterNs, gatherNs});
+            };
+            selection("sel branchy", select_branchy);
+            selection("sel branchless", select_branchless);
+            selection("sel simd", select_simd);
+            
+            auto bitmap = [&](const std::string& name, size_t (*filter)(const uint32_t*, size_t, uint32_t, uint64_t*)) {
+                size_t k = filter(colA.data(), n, limit, bits.data());
+                double filterNs = nsPerRow([&]() { volatile size_t sink = filter(colA.data(), n, limit, bits.data()); (void)sink; });
+                uint64_t sparse = gather_bitmap_sparse(colB.data(), bits.data(), n);
+                uint64_t dense = gather_bitmap_dense(colB.data(), bits.data(), n);
+                if (k != row.matches || sparse != expected || dense != expected) {
+                    std::cerr << "Warning: " << name << " disagrees with the branchy filter" << std::endl;
+                }
+                row.pipelines.push_back({name + " sparse", filterNs, nsPerRow([&]() {
+                    volatile uint64_t sink = gather_bitmap_sparse(colB.data(), bits.data(), n); (void)sink; })});
+                row.pipelines.push_back({name + " dense", filterNs, nsPerRow([&]() {
+                    volatile uint64_t sink = gather_bitmap_dense(colB.data(), bits.data(), n); (void)sink; })});
+            };
+            bitmap("bitmap scalar", bitmap_scalar);
+            bitmap("bitmap simd", bitmap_simd);
+            rows.push_back(row);
+            
+            std::cout << "Selectivity " << std::fixed << std::setprecision(1) << 100.0 * selectivity << "% ("
+                      << row.matches << " rows)" << std::endl;
+            for (const auto& p : row.pipelines) {
+                std::cout << std::setw(22) << p.name << ": filter " << std::setw(6) << std::setprecision(3) << p.filterNs
+                          << "  gather " << std::setw(6) << p.gatherNs << "  total " << std::setw(6)
+                          << p.filterNs + p.gatherNs << " ns/row" << std::endl;
+            }
+        }
+        
+        // Crossovers: selectivities at which the faster of two pipelines changes
+        std::cout << "\nCrossovers (filter + gather):" << std::endl;
+        auto crossover = [&](size_t x, size_t y) {
+            const std::string& nameX = rows[0].pipelines[x].name;
+            const std::string& nameY = rows[0].pipelines[y].name;
+            auto total = [](const Pipeline& p) { return p.filterNs + p.gatherNs; };
+            bool xFaster = total(rows[0].pipelines[x]) <= total(rows[0].pipelines[y]);
+            std::cout << std::setw(22) << nameX << " vs " << std::setw(20) << nameY << ": "
+                      << (xFaster ? nameX : nameY) << " from " << std::setprecision(1) << 100.0 * rows[0].selectivity << "%";
+            for (const auto& row : rows) {
+                bool faster = total(row.pipelines[x]) <= total(row.pipelines[y]);
+                if (faster == xFaster) continue;
+                xFaster = faster;
+                std::cout << ", " << (xFaster ? nameX : nameY) << " from " << 100.0 * row.selectivity << "%";
+            }
+            std::cout << std::endl;
+        };
+        crossover(0, 1); // Branchy vs branchless
+        crossover(1, 2); // Branchless vs SIMD
+        crossover(2, 5); // Selection vector vs bitmap, both SIMD, sparse gather
+        crossover(5, 6); // Sparse vs dense bitmap gather
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Selectivity_percent,Matches,Pipeline,Filter_ns_per_row,Gather_ns_per_row,Total_ns_per_row" << std::endl;
+        for (const auto& row : rows) {
+            for (const auto& p : row.pipelines) {
+                std::cout << std::setprecision(2) << 100.0 * row.selectivity << "," << row.matches << "," << p.name << ","
+                          << std::setprecision(4) << p.filterNs << "," << p.gatherNs << "," << p.filterNs + p.gatherNs
+                          << std::endl;
+            }
+        }
+    }
+    
+    // Gather library support: `base` holds uint32_t values derived from arr,
+    // and the current pattern's indices are scaled onto it, keeping their order
+    void fillGatherBase(std::vector<uint32_t>& base, size_t count) const {
+        base.resize(count);
+        for (size_t i = 0; i < count; i++) base[i] = arr[i & (ARRAY_SIZE - 1)].a ^ static_cast<uint32_t>(i);
+    }
+    
+    std::vector<size_t> scaledIndices(size_t count) const {
+        std::vector<size_t> scaled(indices.size());
+        const size_t slots = indices.size();
+        for (size_t j = 0; j < slots; j++) scaled[j] = static_cast<size_t>((indices[j] / 8) * (static_cast<double>(count) / slots));
+        return scaled;
+    }
+    
+    static double timeGatherStrategy(GatherStrategy strategy, const std::vector<uint32_t>& base,
+                                     const std::vector<size_t>& idx, std::vector<uint32_t>& out,
+                                     const GatherTuning& tuning) {
+        const int iterations = 5, warmup = 1;
+        std::vector<double> times = timePasses([&]() {
+            gather_with(strategy, base.data(), base.size(), idx.data(), idx.size(), out.data(), tuning);
+        }, iterations, warmup);
+        return times[iterations / 2] * 1e6 / idx.size();
+    }
+    
+    // Tunes prefetch distance, sort batch and partition size on the largest
+    // base, then picks the fastest strategy for each base size, all with the
+    // Random pattern (the case the strategies exist for)
+    GatherTuning calibrateGatherTuning(size_t maxBytes, bool verbose) {
+        CacheTopology topo = detect_cache_topology();
+        GatherTuning tuning;
+        std::vector<uint32_t> base, out(indices.size());
+        generateRandomIndices();
+        
+        size_t largest = 32 * 1024;
+        while (largest * 4 <= maxBytes) largest *= 4;
+        fillGatherBase(base, largest / sizeof(uint32_t));
+        std::vector<size_t> idx = scaledIndices(base.size());
+        
+        auto sweep = [&](const char* name, GatherStrategy strategy, size_t& parameter, std::vector<size_t> candidates) {
+            double best = std::numeric_limits<double>::max();
+            size_t bestValue = parameter;
+            for (size_t value : candidates) {
+                parameter = value;
+                double ns = timeGatherStrategy(strategy, base, idx, out, tuning);
+                if (verbose) {
+                    std::cout << "  " << name << " " << value << ": " << std::fixed << std::setprecision(2) << ns
+                              << " ns/element" << std::endl;
+                }
+                if (ns < best) {
+                    best = ns;
+                    bestValue = value;
+                }
+            }
+            parameter = bestValue;
+        };
+        if (verbose) std::cout << "Calibrating on a " << largest / 1024 << " KiB base" << std::endl;
+        sweep("prefetch distance", GatherStrategy::Prefetch, tuning.prefetchDistance, {4, 8, 16, 32, 64, 128});
+        sweep("sort batch", GatherStrategy::BatchSort, tuning.batchSize, {1024, 4096, 16384, 65536});
+        std::vector<size_t> partitionSizes;
+        for (size_t bytes : {topo.l1d, topo.l2 / 2, topo.l2, topo.l3 / 4}) {
+            if (bytes < largest) partitionSizes.push_back(bytes); // Larger regions would not split the base
+        }
+        if (!partitionSizes.empty()) sweep("partition bytes", GatherStrategy::Partition, tuning.partitionBytes, partitionSizes);
+        
+        for (size_t bytes = 32 * 1024; bytes <= largest; bytes *= 4) {
+            fillGatherBase(base, bytes / sizeof(uint32_t));
+            idx = scaledIndices(base.size());
+            // Leave the plain loop only for a gain above timing noise (5%)
+            GatherStrategy best = GatherStrategy::Plain;
+            double bestNs = timeGatherStrategy(GatherStrategy::Plain, base, idx, out, tuning) * 0.95;
+            for (GatherStrategy strategy : gather_strategies()) {
+                if (strategy == GatherStrategy::Plain) continue;
+                double ns = timeGatherStrategy(strategy, base, idx, out, tuning);
+                if (ns < bestNs) {
+                    bestNs = ns;
+                    best = strategy;
+                }
+            }
+            tuning.bySize.push_back({bytes, best});
+            if (verbose) {
+                std::cout << "  " << std::setw(9) << bytes / 1024 << " KiB base: " << gather_strategy_name(best)
+                          << std::endl;
+            }
+        }
+        return tuning;
+    }
+    
+    // Calibrates the gather library, checks every strategy against the plain
+    // loop, then compares gather() with each fixed strategy per pattern and base size
+    void runGatherSuite(size_t maxBytes, const MemoryProfile* profile) {
+        std::cout << "Gather Library Benchmark (C++)" << std::endl;
+        std::cout << indices.size() << " uint32_t gathers per pass, base sizes 32 KiB to " << maxBytes / 1024 << " KiB"
+#ifdef __AVX2__
+                  << ", AVX2 gather"
+#else
+                  << ", simd falls back to plain (build with -mavx2 for AVX2)"
+#endif
+                  << "\n" << std::endl;
+        
+        default_gather_tuning() = profile ? profile->gather : calibrateGatherTuning(maxBytes, true);
+        const GatherTuning& tuning = default_gather_tuning();
+        std::cout << (profile ? "Tuning from profile" : "Tuning") << ": prefetch distance " << tuning.prefetchDistance << ", sort batch " << tuning.batchSize
+                  << ", partition " << tuning.partitionBytes / 1024 << " KiB\n" << std::endl;
+        
+        struct Row { std::string pattern; size_t kib; std::string strategy, chosen; double nsPerElement; };
+        std::vector<Row> rows;
+        std::vector<uint32_t> base, expected, out(indices.size()), autoOut;
+        
+        for (size_t bytes = 32 * 1024; bytes <= maxBytes; bytes *= 4) {
+            fillGatherBase(base, bytes / sizeof(uint32_t));
+            for (const auto& pattern : patternNames()) {
+                generateNamedIndices(pattern);
+                std::vector<size_t> idx = scaledIndices(base.size());
+                
+                // Self-check: every strategy and gather() must reproduce the plain loop
+                gather_plain(base.data(), idx.data(), idx.size(), out.data());
+                expected = out;
+                for (GatherStrategy strategy : gather_strategies()) {
+                    std::fill(out.begin(), out.end(), 0);
+                    gather_with(strategy, base.data(), base.size(), idx.data(), idx.size(), out.data(), tuning);
+                    if (out != expected) std::cerr << "Warning: " << gather_strategy_name(strategy) << " gather mismatch" << std::endl;
+                }
+                gather(base, idx, autoOut);
+                if (autoOut != expected) std::cerr << "Warning: gather() mismatch" << std::endl;
+                
+                std::cout << std::setw(12) << pattern << std::setw(9) << bytes / 1024 << " KiB:";
+                for (GatherStrategy strategy : gather_strategies()) {
+                    double ns = timeGatherStrategy(strategy, base, idx, out, tuning);
+                    rows.push_back({pattern, bytes / 1024, gather_strategy_name(strategy), "", ns});
+                    std::cout << " " << gather_strategy_name(strategy) << " " << std::fixed << std::setprecision(2) << ns;
+                }
+                const int iterations = 5, warmup = 1;
+                std::vector<double> times = timePasses([&]() { gather(base, idx, autoOut); }, iterations, warmup);
+                std::string chosen = gather_strategy_name(tuning.choose(bytes));
+                rows.push_back({pattern, bytes / 1024, "gather()", chosen, times[iterations / 2] * 1e6 / idx.size()});
+                std::cout << " | gather() " << rows.back().nsPerElement << " (" << chosen << ") ns/element" << std::endl;
+            }
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Base_KiB,Strategy,Chosen,Ns_per_element" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.pattern << "," << row.kib << "," << row.strategy << "," << row.chosen << ","
+                      << std::setprecision(3) << row.nsPerElement << std::endl;
+        }
+    }
+    
+    // Reference measurements stored in a profile and repeated by verification:
+    // gather ns/access for the Sequential and Random patterns, and
+    // single-thread triad bandwidth over arr-sized arrays
+    void measureProfileReferences(MemoryProfile& profile) {
+        generateSequentialIndices();
+        profile.sequentialNs = timeCurrentIndices(NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2] * 1e6 / indices.size();
+        generateRandomIndices();
+        profile.randomNs = timeCurrentIndices(NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2] * 1e6 / indices.size();
+        const int iterations = 5, warmup = 1;
+        StreamArrays stream(ARRAY_SIZE);
+        std::vector<double> times = timePasses([&]() { stream.triad(3.0); }, iterations, warmup);
+        profile.triadGBps = 3.0 * sizeof(double) * ARRAY_SIZE / (times[iterations / 2] * 1e6);
+    }
+    
+    // Fewest threads whose aggregate triad bandwidth is within 5% of the best
+    // seen; the arrays total four times the LLC (64 MiB to 512 MiB)
+    unsigned calibrateBandwidthThreads() {
+        CacheTopology topo = detect_cache_topology();
+        const size_t totalBytes = std::min<size_t>(512u << 20, std::max<size_t>(64u << 20, 4 * topo.l3));
+        const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        const int iterations = 3, warmup = 1;
+        std::vector<std::pair<unsigned, double>> results;
+        double best = 0.0;
+        
+        std::vector<unsigned> counts;
+        for (unsigned threads = 1; threads < maxThreads; threads = threads < 4 ? threads + 1 : threads * 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(maxThreads);
+        
+        for (unsigned threads : counts) {
+            size_t perThread = totalBytes / (3 * sizeof(double)) / threads;
+            std::vector<std::unique_ptr<StreamArrays>> streams;
+            for (unsigned t = 0; t < threads; t++) streams.emplace_back(new StreamArrays(perThread));
+            std::vector<double> times = timePasses([&]() {
+                std::vector<std::thread> workers;
+                for (unsigned t = 0; t < threads; t++) workers.emplace_back([&, t]() { streams[t]->triad(3.0); });
+                for (auto& worker : workers) worker.join();
+            }, iterations, warmup);
+            double gbps = 3.0 * sizeof(double) * perThread * threads / (times[iterations / 2] * 1e6);
+            std::cout << "  triad threads " << threads << ": " << std::fixed << std::setprecision(2) << gbps << " GB/s" << std::endl;
+            results.push_back({threads, gbps});
+            best = std::max(best, gbps);
+        }
+        for (const auto& result : results) {
+            if (result.second >= 0.95 * best) return result.first;
+        }
+        return 1;
+    }
+    
+    // Fastest blocked transpose and matmul tiles at an LLC-exceeding and an
+    // L2-exceeding size respectively
+    void calibrateTiles(MemoryProfile& profile) {
+        const int iterations = 3, warmup = 1;
+        auto fastest = [&](const char* name, std::vector<size_t> tiles, auto pass) {
+            size_t bestTile = tiles[0];
+            double best = std::numeric_limits<double>::max();
+            for (size_t tile : tiles) {
+                double ms = timePasses([&]() { pass(tile); }, iterations, warmup)[iterations / 2];
+                std::cout << "  " << name << " tile " << tile << ": " << std::fixed << std::setprecision(2) << ms << " ms" << std::endl;
+                if (ms < best) {
+                    best = ms;
+                    bestTile = tile;
+                }
+            }
+            return bestTile;
+        };
+        
+        // Transpose source and destination together span at least 4x the LLC
+        const size_t llc = profile.machine.l3 ? profile.machine.l3 : detect_cache_topology().l3;
+        size_t n = 1024;
+        while (2 * n * n * sizeof(uint32_t) < 4 * llc) n *= 2;
+        std::cout << "  transpose n = " << n << " (" << 2 * n * n * sizeof(uint32_t) / (1024 * 1024)
+                  << " MiB, LLC " << llc / (1024 * 1024) << " MiB)" << std::endl;
+        std::vector<uint32_t> a(n * n), b(n * n);
+        for (size_t i = 0; i < n * n; i++) a[i] = arr[i % ARRAY_SIZE].a;
+        profile.transposeTile = fastest("transpose", {4, 8, 16, 32, 64},
+                                        [&](size_t tile) { transpose_blocked(a.data(), b.data(), n, tile); });
+        n = 512;
+        std::vector<uint32_t> c(n * n);
+        for (size_t i = 0; i < n * n; i++) b[i] = arr[i].b;
+        profile.matmulTile = fastest("matmul", {16, 32, 64, 128},
+                                     [&](size_t tile) { matmul_blocked(a.data(), b.data(), c.data(), n, tile); });
+    }
+    
+    // Runs every sweep once and writes the profile to `path`
+    int runCalibration(const std::string& path, size_t maxBytes) {
+        MemoryProfile profile;
+        profile.machine = detect_machine_identity();
+        profile.created = static_cast<int64_t>(std::time(nullptr));
+        std::cout << "Memory Profile Calibration (C++)" << std::endl;
+        std::cout << "CPU: " << profile.machine.cpuModel << ", " << profile.machine.logicalCpus << " logical CPUs, "
+                  << profile.machine.kernel << "\n" << std::endl;
+        
+        std::cout << "Gather tuning:" << std::endl;
+        profile.gather = calibrateGatherTuning(maxBytes, true);
+        std::cout << "Tiles:" << std::endl;
+        calibrateTiles(profile);
+        std::cout << "Bandwidth threads:" << std::endl;
+        profile.bandwidthThreads = calibrateBandwidthThreads();
+        measureProfileReferences(profile);
+        
+        std::ofstream file(path);
+        file << profile.toJson();
+        if (!file) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "\nWrote " << path << ":\n" << profile.toJson();
+        return 0;
+    }
+    
+    // Quick staleness check: the profile must match this machine's identity,
+    // and the reference measurements must be within `tolerance` (relative) of
+    // a fresh run. Returns 0 when fresh, 2 when stale, 1 when unreadable
+    int verifyProfile(const std::string& path, double tolerance) {
+        MemoryProfile profile;
+        std::string error;
+        ProfileStatus status = read_memory_profile(path, profile, error);
+        if (status != ProfileStatus::Ok) {
+            bool outdatedFormat = status == ProfileStatus::OutdatedVersion;
+            std::cout << (outdatedFormat ? "Profile is STALE: " : "Profile unusable: ") << error << std::endl;
+            return outdatedFormat ? 2 : 1;
+        }
+        
+        std::vector<std::string> reasons;
+        for (const auto& field : profile.identityMismatches(detect_machine_identity())) {
+            reasons.push_back(field + " differs from this machine");
+        }
+        MemoryProfile current;
+        measureProfileReferences(current);
+        auto check = [&](const char* name, double stored, double measured) {
+            double change = stored > 0.0 ? measured / stored - 1.0 : 1.0;
+            std::cout << std::setw(16) << name << ": profile " << std::fixed << std::setprecision(3) << stored
+                      << ", now " << measured << " (" << std::showpos << std::setprecision(1) << 100.0 * change
+                      << std::noshowpos << "%)" << std::endl;
+            if (std::fabs(change) > tolerance) reasons.push_back(std::string(name) + " moved beyond tolerance");
+        };
+        std::cout << "Verifying " << path << " (created " << (std::time(nullptr) - profile.created) / 86400
+                  << " days ago, tolerance " << 100.0 * tolerance << "%)" << std::endl;
+        check("sequential ns", profile.sequentialNs, current.sequentialNs);
+        check("random ns", profile.randomNs, current.randomNs);
+        check("triad GB/s", profile.triadGBps, current.triadGBps);
+        
+        if (reasons.empty()) {
+            std::cout << "Profile is fresh" << std::endl;
+            return 0;
+        }
+        std::cout << "Profile is STALE:" << std::endl;
+        for (const auto& reason : reasons) std::cout << "  - " << reason << std::endl;
+        return 2;
+    }
+    
+    // 4K-aliasing detector for `indices` and `arr`: reports both page offsets and
+    // times a pass that loads indices[j] and stores to the j-th 8-byte word of
+    // arr. Both streams advance 8 bytes per access, so the store - load distance
+    // modulo 4096 stays fixed for the whole pass. It runs with the indices at
+    // their real address and copied to distances 64 and 2048 below arr. A load
+    // whose low 12 address bits match an older in-flight store is held back as
+    // a possible dependency, so a store a few words ahead of the loads (64)
+    // shows the worst case
+    void detectIndexAliasing() {
+        const int iterations = 5, warmup = 1;
+        generateSequentialIndices();
+        uint64_t* words = reinterpret_cast<uint64_t*>(arr.data());
+        auto storeNs = [&](const size_t* idx) {
+            std::vector<double> times = timePasses([&]() {
+                for (size_t j = 0; j < indices.size(); j++) {
+                    uint64_t value = idx[j];
+                    keep_in_register(value);
+                    words[j] += value;
+                }
+            }, iterations, warmup);
+            return times[iterations / 2] * 1e6 / indices.size();
+        };
+        
+        std::vector<size_t> aligned, apart;
+        size_t* alignedIdx = place_at_page_offset(aligned, indices.size(), arr.data(), 4096 - 64);
+        size_t* apartIdx = place_at_page_offset(apart, indices.size(), arr.data(), 2048);
+        std::copy(indices.begin(), indices.end(), alignedIdx);
+        std::copy(indices.begin(), indices.end(), apartIdx);
+        double actualNs = storeNs(indices.data());
+        double alignedNs = storeNs(alignedIdx);
+        double apartNs = storeNs(apartIdx);
+        
+        std::cout << "4K aliasing between indices and arr:" << std::endl;
+        std::cout << "  arr page offset " << page_offset(arr.data()) << ", indices page offset " << page_offset(indices.data())
+                  << ", arr - indices = " << (page_offset(arr.data()) + 4096 - page_offset(indices.data())) % 4096
+                  << " mod 4096" << std::endl;
+        std::cout << "  Sequential store pass: actual " << std::fixed << std::setprecision(3) << actualNs
+                  << " ns, distance 64 " << alignedNs << " ns, distance 2048 " << apartNs << " ns per access" << std::endl;
+        bool sensitive = alignedNs > 1.05 * apartNs;
+        bool affected = sensitive && actualNs > 1.05 * apartNs;
+        std::cout << "  " << (affected ? "ALIASING: the real allocation runs at the aliased speed"
+                              : sensitive ? "no aliasing at the real allocation (distance 64 would alias)"
+                                          : "no measurable 4K-aliasing penalty on this machine")
+                  << "\n" << std::endl;
+    }
+    
+    // 4K aliasing / store-forwarding sweep. A load whose address matches an
+    // older in-flight store in bits 0-11 is treated as possibly dependent and
+    // waits, so each hazard pairs a load stream with a store stream placed at
+    // a controlled offset (store - load, modulo 4096):
+    //   sum store vs arr     - a volatile accumulator, moved relative to arr
+    //   out store vs indices - a gather writing out[j], moved relative to indices
+    //   arr store vs indices - words[j] += idx[j] over arr's 8-byte words, with
+    //                          idx moved relative to arr
+    void runAliasSuite() {
+        const int iterations = 3, warmup = 1;
+        std::vector<size_t> offsets;
+        for (size_t d = 0; d < 64; d += 8) offsets.push_back(d);
+        for (size_t d = 128; d < 4032; d += 128) offsets.push_back(d);
+        for (size_t d = 4032; d < 4096; d += 8) offsets.push_back(d);
+        
+        std::cout << "4K Aliasing / Store-Forwarding Benchmark (C++)" << std::endl;
+        std::cout << "arr page offset " << page_offset(arr.data()) << ", indices page offset " << page_offset(indices.data())
+                  << "; " << offsets.size() << " store offsets per hazard, ns/access\n" << std::endl;
+        
+        // Aliasing needs the store within a few words of some load modulo 4096,
+        // so the penalty compares the mean over offsets within 64 bytes of a
+        // load's page offset ("near") with the mean over the rest ("far");
+        // averaging keeps run-to-run noise out of the verdict. Record loads
+        // only hit every 256th byte of a page, so the sum store aliases at
+        // every multiple of 256, not just near 0
+        struct Point { std::string hazard, pattern; size_t offset; double ns; };
+        struct Summary { std::string hazard, pattern; double nearNs, farNs, worstNs, headlineNs; size_t worstOffset; };
+        std::vector<Point> points;
+        std::vector<Summary> summaries;
+        std::vector<uint64_t> sinkStorage, outStorage;
+        std::vector<size_t> idxStorage;
+        
+        auto nsPerAccess = [&](auto pass) {
+            return timePasses(pass, iterations, warmup)[iterations / 2] * 1e6 / indices.size();
+        };
+        
+        for (const auto& pattern : patternNames()) {
+            generateNamedIndices(pattern);
+            double headline = timeCurrentIndices(NUM_ITERATIONS, WARMUP_ITERATIONS)[NUM_ITERATIONS / 2] * 1e6 / indices.size();
+            
+            // Page offsets of the arr loads relative to arr, one flag per 8 bytes
+            std::vector<bool> recordLoads(4096 / 8, false);
+            for (size_t index : indices) recordLoads[index * sizeof(DataStruct) % 4096 / 8] = true;
+            std::vector<bool> streamLoads(4096 / 8, false);
+            streamLoads[0] = true; // Store j against load j of a sequential stream
+            
+            // `loads` flags the load page offsets relative to the store anchor;
+            // measureAt returns ns/access at a store offset
+            auto sweep = [&](const std::string& hazard, const std::vector<bool>& loads, auto measureAt) {
+                Summary summary{hazard, pattern, 0.0, 0.0, 0.0, headline, 0};
+                size_t nearCount = 0, farCount = 0;
+                for (size_t offset : offsets) {
+                    double ns = measureAt(offset);
+                    points.push_back({hazard, pattern, offset, ns});
+                    size_t distance = 4096;
+                    for (size_t slot = 0; slot < loads.size(); slot++) {
+                        if (!loads[slot]) continue;
+                        size_t apart = (offset + 4096 - slot * 8) % 4096;
+                        distance = std::min(distance, std::min(apart, 4096 - apart));
+                    }
+                    bool near = distance < 64;
+                    (near ? summary.nearNs : summary.farNs) += ns;
+                    (near ? nearCount : farCount)++;
+                    if (ns > summary.worstNs) {
+                        summary.worstNs = ns;
+                        summary.worstOffset = offset;
+                    }
+                }
+                summary.nearNs /= nearCount;
+                summary.farNs /= farCount;
+                summaries.push_back(summary);
+                std::cout << std::setw(22) << hazard << std::setw(12) << pattern << ": near " << std::fixed
+                          << std::setprecision(3) << summary.nearNs << ", far " << summary.farNs << ", penalty "
+                          << std::setprecision(1) << std::setw(5) << 100.0 * (summary.nearNs / summary.farNs - 1.0)
+                          << "%, worst " << std::setprecision(3) << summary.worstNs << " @" << summary.worstOffset;
+                if (hazard == "sum store vs arr") std::cout << ", headline " << headline << " ns";
+                std::cout << std::endl;
+            };
+            
+            sweep("sum store vs arr", recordLoads, [&](size_t offset) {
+                volatile uint64_t* sink = place_at_page_offset(sinkStorage, 1, arr.data(), offset);
+                *sink = 0;
+                return nsPerAccess([&]() {
+                    for (size_t j = 0; j < indices.size(); j++) *sink += arr[indices[j]].a;
+                });
+            });
+            sweep("out store vs indices", streamLoads, [&](size_t offset) {
+                volatile uint64_t* out = place_at_page_offset(outStorage, indices.size(), indices.data(), offset);
+                return nsPerAccess([&]() {
+                    for (size_t j = 0; j < indices.size(); j++) out[j] = arr[indices[j]].a;
+                });
+            });
+            sweep("arr store vs indices", streamLoads, [&](size_t offset) {
+                // idx starts `offset` below arr; the stores walk arr's 8-byte
+                // words in step with the idx loads, so the distance stays fixed
+                size_t* idx = place_at_page_offset(idxStorage, indices.size(), arr.data(), (4096 - offset) % 4096);
+                uint64_t* words = reinterpret_cast<uint64_t*>(arr.data());
+                std::copy(indices.begin(), indices.end(), idx);
+                return nsPerAccess([&]() {
+                    for (size_t j = 0; j < indices.size(); j++) {
+                        uint64_t value = idx[j];
+                        keep_in_register(value);
+                        words[j] += value;
+                    }
+                });
+            });
+        }
+        
+        // A significant near-offset penalty plus a headline above the far
+        // (alias-free) mean suggests the default layout carries the artifact
+        std::cout << std::endl;
+        for (const auto& summary : summaries) {
+            if (summary.hazard != "sum store vs arr") continue;
+            bool sensitive = summary.nearNs > 1.05 * summary.farNs;
+            bool artifact = sensitive && summary.headlineNs > 1.05 * summary.farNs;
+            std::cout << std::setw(12) << summary.pattern << ": "
+                      << (artifact ? "headline is above the alias-free mean; check buffer placement"
+                          : sensitive ? "sum-store aliasing possible, but the headline is not affected"
+                                      : "no sum-store aliasing penalty") << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Hazard,Pattern,Store_offset,Ns_per_access" << std::endl;
+        for (const auto& point : points) {
+            std::cout << point.hazard << "," << point.pattern << "," << point.offset << ","
+                      << std::setprecision(4) << point.ns << std::endl;
+        }
+    }
+    
+    // Runs the five patterns over small working sets (1 KiB to 1 MiB of records,
+    // followed by their uint32_t indices) placed on the stack, in a static
+    // array, in thread_local storage and on the heap; every buffer starts on a
+    // cache line. Each timed pass repeats the working set to ~4M accesses
+    void runPlacementSuite() {
+        const int iterations = 5, warmup = 1;
+        const size_t accessesPerPass = 1 << 22;
+        const size_t stackLimit = placement_stack_limit();
+        std::cout << "Buffer Placement Benchmark (C++)" << std::endl;
+        std::cout << "ns/access; stack buffers up to " << stackLimit / 1024 << " KiB, thread_local up to "
+                  << PLACEMENT_TLS_BYTES / (sizeof(DataStruct) + sizeof(uint32_t)) * sizeof(DataStruct) / 1024
+                  << " KiB\n" << std::endl;
+        detectIndexAliasing();
+        
+        struct Row { std::string region, pattern; size_t kib; double ns; };
+        std::vector<Row> rows;
+        const std::vector<std::string> regions = {"stack", "static", "thread_local", "heap"};
+        const std::vector<size_t> fullIndices = indices;
+        
+        std::cout << std::setw(14) << "Region" << std::setw(10) << "KiB";
+        for (const auto& name : patternNames()) std::cout << std::setw(12) << name;
+        std::cout << std::endl;
+        
+        for (size_t bytes = 1024; bytes <= (1 << 20); bytes *= 2) {
+            const size_t n = bytes / sizeof(DataStruct);
+            const size_t bufferBytes = n * (sizeof(DataStruct) + sizeof(uint32_t));
+            const size_t reps = std::max<size_t>(1, accessesPerPass / n);
+            
+            // Pattern orders over n records: the generators fill indices.size() slots
+            std::vector<std::vector<uint32_t>> orders;
+            indices.assign(n, 0);
+            for (const auto& name : patternNames()) {
+                generateNamedIndices(name);
+                orders.emplace_back(n);
+                for (size_t j = 0; j < n; j++) orders.back()[j] = static_cast<uint32_t>(indices[j] / 8);
+            }
+            
+            auto measure = [&](const std::string& region, unsigned char* buffer) {
+                DataStruct* data = reinterpret_cast<DataStruct*>(buffer);
+                uint32_t* idx = reinterpret_cast<uint32_t*>(buffer + n * sizeof(DataStruct));
+                std::copy(arr.begin(), arr.begin() + n, data);
+                std::cout << std::setw(14) << region << std::setw(10) << bytes / 1024;
+                for (size_t p = 0; p < orders.size(); p++) {
+                    std::copy(orders[p].begin(), orders[p].end(), idx);
+                    std::vector<double> times = timePasses([&]() {
+                        uint64_t sum = 0;
+                        for (size_t r = 0; r < reps; r++) {
+                            for (size_t j = 0; j < n; j++) {
+                                sum += data[idx[j]].a;
+                                keep_in_register(sum);
+                            }
+                        }
+                        volatile uint64_t sink = sum;
+                        (void)sink;
+                    }, iterations, warmup);
+                    rows.push_back({region, patternNames()[p], bytes / 1024, times[iterations / 2] * 1e6 / (reps * n)});
+                    std::cout << std::setw(12) << std::fixed << std::setprecision(3) << rows.back().ns;
+                }
+                std::cout << std::endl;
+            };
+            
+            for (const auto& region : regions) {
+                if (region == "stack") {
+                    if (bufferBytes > stackLimit) continue;
+                    with_stack_buffer(bufferBytes, [&](unsigned char* buffer) { measure(region, buffer); });
+                } else if (region == "static") {
+                    measure(region, placement_static);
+                } else if (region == "thread_local") {
+                    if (bufferBytes > PLACEMENT_TLS_BYTES) continue;
+                    measure(region, placement_thread_local);
+                } else {
+                    std::unique_ptr<unsigned char[]> heap(new unsigned char[bufferBytes + 64]);
+                    uintptr_t address = reinterpret_cast<uintptr_t>(heap.get());
+                    measure(region, heap.get() + (64 - address % 64) % 64);
+                }
+            }
+        }
+        indices = fullIndices;
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Region,WorkingSet_KiB,Pattern,Ns_per_access" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.region << "," << row.kib << "," << row.pattern << "," << std::setprecision(4) << row.ns << std::endl;
+        }
+    }
+    
+    // Adds a branch on each loaded record, taken when its uniformly random `a`
+    // field is below a threshold, to every pattern. Three kernels share one loop:
+    //   load       - sum += a, the memory cost alone
+    //   branchy    - if (a < threshold) sum += b
+    //   branchless - sum += b & mask(a < threshold)
+    // Branch outcomes depend only on the data, so they are equally predictable
+    // under every pattern: branchy - branchless is the misprediction cost, and
+    // load minus Sequential's load is the memory stall
+    void runBranchSuite(const std::vector<double>& takenPercents) {
+        const int iterations = 5, warmup = 1;
+        const double accesses = static_cast<double>(indices.size());
+        PerfCounters counters;
+        bool haveMisses = counters.add("branch-misses", PerfCounters::TYPE_HARDWARE, PerfCounters::HW_BRANCH_MISSES);
+        
+        std::cout << "Branch Prediction vs Memory Pattern Benchmark (C++)" << std::endl;
+        std::cout << "ns/access; mispredict = branchy - branchless; misses/access "
+                  << (haveMisses ? "from the branch-misses counter" : "unavailable, expected min(p, 1-p) shown")
+                  << "\n" << std::endl;
+        
+        struct Row { std::string pattern, kernel; double taken, ns, missesPerAccess; };
+        std::vector<Row> rows;
+        volatile uint64_t sink = 0;
+        
+        // Returns median ns/access and sets branch misses per access (NaN when unavailable)
+        auto measure = [&](auto pass, double& missesPerAccess) {
+            counters.start();
+            std::vector<double> times = timePasses(pass, iterations, warmup);
+            counters.stop();
+            missesPerAccess = counters.value("branch-misses") / (accesses * (iterations + warmup));
+            return times[iterations / 2] * 1e6 / accesses;
+        };
+        
+        // Per pattern: load ns, then branchy and branchless ns at each probability
+        std::map<std::string, double> loadNs;
+        std::map<std::string, std::vector<std::pair<double, double>>> kernelNs;
+        for (const auto& pattern : patternNames()) {
+            generateNamedIndices(pattern);
+            double misses;
+            loadNs[pattern] = measure([&]() {
+                uint64_t sum = 0;
+                for (size_t j = 0; j < indices.size(); j++) {
+                    sum += arr[indices[j]].a;
+                    keep_in_register(sum);
+                }
+                sink = sum;
+            }, misses);
+            rows.push_back({pattern, "load", 0.0, loadNs[pattern], misses});
+            
+            std::cout << pattern << " (load " << std::fixed << std::setprecision(3) << loadNs[pattern] << " ns)" << std::endl;
+            std::cout << std::setw(8) << "Taken%" << std::setw(12) << "Branchy" << std::setw(12) << "Branchless"
+                      << std::setw(13) << "Mispredict" << std::setw(14) << "Misses/acc" << std::endl;
+            for (double percent : takenPercents) {
+                // a < limit holds for percent% of uniform 32-bit values; 100% gives 2^32
+                const uint64_t limit = static_cast<uint64_t>(percent / 100.0 * 4294967296.0);
+                double branchyMisses, branchlessMisses;
+                double branchy = measure([&]() {
+                    uint64_t sum = 0;
+                    for (size_t j = 0; j < indices.size(); j++) {
+                        const DataStruct& v = arr[indices[j]];
+                        if (v.a < limit) {
+                            sum += v.b;
+                            keep_in_register(sum);
+                        }
+                    }
+                    sink = sum;
+                }, branchyMisses);
+                double branchless = measure([&]() {
+                    uint64_t sum = 0;
+                    for (size_t j = 0; j < indices.size(); j++) {
+                        const DataStruct& v = arr[indices[j]];
+                        sum += v.b & (0 - static_cast<uint64_t>(v.a < limit));
+                        keep_in_register(sum);
+                    }
+                    sink = sum;
+                }, branchlessMisses);
+                rows.push_back({pattern, "branchy", percent, branchy, branchyMisses});
+                rows.push_back({pattern, "branchless", percent, branchless, branchlessMisses});
+                kernelNs[pattern].push_back({branchy, branchless});
+                
+                std::cout << std::setw(8) << std::setprecision(1) << percent << std::setprecision(3)
+                          << std::setw(12) << branchy << std::setw(12) << branchless
+                          << std::setw(10) << branchy - branchless << " ns" << std::setw(14) << std::setprecision(4);
+                if (haveMisses && !std::isnan(branchyMisses)) std::cout << branchyMisses;
+                else std::cout << std::min(percent, 100.0 - percent) / 100.0;
+                std::cout << std::endl;
+            }
+            std::cout << std::endl;
+        }
+        
+        // Decomposition at the probability nearest 50%: interaction is how much
+        // more (or less) a mispredict costs than under Sequential, i.e. the
+        // part of the branch cost that depends on the memory pattern
+        size_t coin = 0;
+        for (size_t p = 1; p < takenPercents.size(); p++) {
+            if (std::abs(takenPercents[p] - 50.0) < std::abs(takenPercents[coin] - 50.0)) coin = p;
+        }
+        const std::string& baseline = patternNames().front();
+        auto mispredict = [&](const std::string& pattern) {
+            return kernelNs[pattern][coin].first - kernelNs[pattern][coin].second;
+        };
+        std::cout << "At " << std::setprecision(1) << takenPercents[coin] << "% taken (relative to " << baseline << "):"
+                  << std::endl;
+        for (const auto& pattern : patternNames()) {
+            std::cout << std::setw(12) << pattern << ": memory stall " << std::setprecision(3) << std::setw(7)
+                      << loadNs[pattern] - loadNs[baseline] << " ns, mispredict " << std::setw(7) << mispredict(pattern)
+                      << " ns, interaction " << std::setw(7) << mispredict(pattern) - mispredict(baseline) << " ns"
+                      << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Kernel,Taken_percent,Ns_per_access,Branch_misses_per_access" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.pattern << "," << row.kernel << "," << std::setprecision(1) << row.taken << ","
+                      << std::setprecision(4) << row.ns << ",";
+            if (std::isnan(row.missesPerAccess)) std::cout << "n/a";
+            else std::cout << row.missesPerAccess;
+            std::cout << std::endl;
+        }
+    }
+    
+    // One gathered element followed by `rounds` of 64-bit hash mixing. Dependent
+    // rounds chain through one value (multiply latency per round); independent
+    // rounds each mix the loaded value with their own constant, so they overlap
+    // and cost roughly multiply throughput. Elements never depend on each
+    // other, leaving the out-of-order window to overlap misses with the work
+    template<bool DEPENDENT>
+    static void computePass(const std::vector<DataStruct>& data, const std::vector<size_t>& idx, size_t rounds,
+                            volatile uint64_t& sink) {
+        uint64_t sum = 0;
+        for (size_t j = 0; j < idx.size(); j++) {
+            uint64_t x = data[idx[j]].a;
+            if (DEPENDENT) {
+                for (size_t r = 0; r < rounds; r++) {
+                    x = (x ^ (x >> 29)) * 0xbf58476d1ce4e5b9ull;
+                    keep_in_register(x);
+                }
+                sum += x;
+            } else {
+                uint64_t acc = x;
+                for (size_t r = 0; r < rounds; r++) {
+                    uint64_t y = (x ^ (r * 0x9e3779b97f4a7c15ull)) * 0xbf58476d1ce4e5b9ull;
+                    acc += y ^ (y >> 31);
+                    keep_in_register(acc);
+                }
+                sum += acc;
+            }
+            keep_in_register(sum);
+        }
+        sink = sum;
+    }
+    
+    // Sweeps hash rounds per access (0, 1, 2, 4, ... maxRounds) for every
+    // pattern, dependent and independent, and reports the first level at which
+    // Random runs within 5% of Sequential: beyond it the misses are hidden
+    // behind the computation and layout work stops paying off
+    void runComputeSuite(size_t maxRounds) {
+        const int iterations = 3, warmup = 1;
+        const double accesses = static_cast<double>(indices.size());
+        std::vector<size_t> levels = {0};
+        for (size_t r = 1; r <= maxRounds; r *= 2) levels.push_back(r);
+        
+        std::cout << "Compute Intensity Benchmark (C++)" << std::endl;
+        std::cout << "ns/access with N hash rounds (xor-shift + 64-bit multiply) per loaded element\n" << std::endl;
+        
+        struct Row { std::string kind, pattern; size_t rounds; double ns; };
+        std::vector<Row> rows;
+        std::map<std::string, std::map<std::string, std::vector<double>>> ns; // kind -> pattern -> per level
+        volatile uint64_t sink = 0;
+        
+        for (const std::string kind : {"dependent", "independent"}) {
+            std::cout << kind << " rounds" << std::endl;
+            std::cout << std::setw(8) << "Rounds";
+            for (const auto& pattern : patternNames()) std::cout << std::setw(13) << pattern;
+            std::cout << std::endl;
+            
+            for (const auto& pattern : patternNames()) {
+                generateNamedIndices(pattern);
+                for (size_t rounds : levels) {
+                    std::vector<double> times = timePasses([&]() {
+                        if (kind == "dependent") computePass<true>(arr, indices, rounds, sink);
+                        else computePass<false>(arr, indices, rounds, sink);
+                    }, iterations, warmup);
+                    ns[kind][pattern].push_back(times[iterations / 2] * 1e6 / accesses);
+                    rows.push_back({kind, pattern, rounds, ns[kind][pattern].back()});
+                }
+            }
+            for (size_t l = 0; l < levels.size(); l++) {
+                std::cout << std::setw(8) << levels[l];
+                for (const auto& pattern : patternNames()) {
+                    std::cout << std::setw(13) << std::fixed << std::setprecision(3) << ns[kind][pattern][l];
+                }
+                std::cout << std::endl;
+            }
+            
+            const std::vector<double>& sequential = ns[kind]["Sequential"];
+            const std::vector<double>& random = ns[kind]["Random"];
+            size_t crossover = levels.size();
+            for (size_t l = 0; l < levels.size() && crossover == levels.size(); l++) {
+                if (random[l] <= 1.05 * sequential[l]) crossover = l;
+            }
+            // Once one element's work fills the reorder window, misses stop
+            // overlapping and the gap settles at about one miss latency
+            std::cout << "Random - Sequential: " << std::setprecision(1) << random[0] - sequential[0]
+                      << " ns at 0 rounds, " << random.back() - sequential.back() << " ns at " << levels.back()
+                      << " rounds" << std::endl;
+            if (crossover < levels.size()) {
+                std::cout << "Random reaches Sequential throughput (within 5%) at " << levels[crossover]
+                          << " rounds, " << std::setprecision(1) << sequential[crossover] << " ns of work per access";
+            } else {
+                std::cout << "Random stays " << std::setprecision(2) << random.back() / sequential.back()
+                          << "x slower at " << levels.back() << " rounds";
+            }
+            std::cout << "\n" << std::endl;
+        }
+        
+        std::cout << "CSV_OUTPUT:" << std::endl;
+        std::cout << "Kind,Pattern,Rounds,Ns_per_access" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.kind << "," << row.pattern << "," << row.rounds << "," << std::setprecision(4) << row.ns << std::endl;
+        }
+    }
+    
+    // One logical access follows DEPTH - 1 links from the first record: its
+    // b field names the second record, whose c names the third, whose d names
+    // the fourth. Prefetching covers only the first level, the one address
+    // known ahead of time
+    template<int DEPTH, bool PREFETCH>
+    static void chasePass(const std::vector<DataStruct>& graph, const std::vector<size_t>& first, size_t distance,
+                          volatile uint64_t& sink) {
+        uint64_t sum = 0;
+        for (size_t j = 0; j < first.size(); j++) {
+            if (PREFETCH && j + distance < first.size()) prefetch_read(&graph[first[j + distance]]);
+            const DataStruct* record = &graph[first[j]];
+            if (DEPTH > 1) record = &graph[record->b];
+            if (DEPTH > 2) record = &graph[record->c];
+            if (DEPTH > 3) record = &graph[record->d];
+            sum += record->a;
+            keep_in_register(sum);
+        }
+        sink = sum;
+    }
+    
+    template<bool PREFETCH>
+    static void chasePass(int depth, const std::vector<DataStruct>& graph, const std::vector<size_t>& first,
+                          size_t distance, volatile uint64_t& sink) {
+        switch (depth) {
+            case 1: chasePass<1, PREFETCH>(graph, first, distance, sink); break;
+            case 2: chasePass<2, PREFETCH>(graph, first, distance, sink); break;
+            case 3: chasePass<3, PREFETCH>(graph, first, distance, sink); break;
+            default: chasePass<4, PREFETCH>(graph, first, distance, sink); break;
+        }
+    }
+    
+    // Multi-level indirection: each chain of up to four levels names the
+    // pattern of every level. Level k uses record 2k of each 8-record slot, so
+    // levels sit on different cache lines, and the links are written into a
+    // copy of arr so the visit order at every level is exactly its pattern
+    void runIndirectionSuite(const std::vector<std::vector<std::string>>& chains) {
+        const int iterations = 5, warmup = 1;
+        const size_t distance = default_gather_tuning().prefetchDistance;
+        const double accesses = static_cast<double>(indices.size());
+        
+        std::cout << "Multi-Level Indirection Benchmark (C++)" << std::endl;
+        std::cout << "ns per logical access; prefetch is " << distance << " accesses ahead on the first level only\n"
+                  << std::endl;
+        
+        struct Row { std::string chain; int depth; double plainNs, prefetchNs; };
+        std::vector<Row> rows;
+        std::vector<DataStruct> graph = arr;
+        volatile uint64_t sink = 0;
+        
+        for (const auto& chain : chains) {
+            std::string chainName;
+            std::vector<size_t> first, previous;
+            for (size_t level = 0; level < chain.size(); level++) {
+                generateNamedIndices(chain[level]);
+                for (size_t& index : indices) index += 2 * level;
+                if (level == 0) first = indices;
+                for (size_t j = 0; level > 0 && j < indices.size(); j++) {
+                    uint32_t next = static_cast<uint32_t>(indices[j]);
+                    if (level == 1) graph[previous[j]].b = next;
+                    else if (level == 2) graph[previous[j]].c = next;
+                    else graph[previous[j]].d = next;
+                }
+                previous = indices;
+                chainName += (level ? ">" : "") + chain[level];
+            }
+            
+            std::cout << chainName << std::endl;
+            std::cout << std::setw(8) << "Depth" << std::setw(12) << "Plain" << std::setw(12) << "Per level"
+                      << std::setw(12) << "Prefetch" << std::setw(10) << "Speedup" << std::endl;
+            for (int depth = 1; depth <= static_cast<int>(chain.size()); depth++) {
+                double plain = timePasses([&]() { chasePass<false>(depth, graph, first, distance, sink); },
+                                          iterations, warmup)[iterations / 2] * 1e6 / accesses;
+                double prefetched = timePasses([&]() { chasePass<true>(depth, graph, first, distance, sink); },
+                                               iterations, warmup)[iterations / 2] * 1e6 / accesses;
+                rows.push_back({chainName, depth, plain, prefetched});
+                std::cout << std::setw(8) << depth << std::setw(12) << std::fixed << std::setprecision(3) << plain
+                          << std::setw(12) << plain / depth << std::setw(12) << prefetched
+                          << std::setw(9) << std::setprecision(2) << plain / prefetched << "x" << std::endl;
+            }
+            std::cout << std::endl;
+        }
+        
+        std::cout << "CSV_OUTPUT:" << std::endl;
+        std::cout << "Chain,Depth,Ns_per_access,Ns_per_access_prefetch" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.chain << "," << row.depth << "," << std::setprecision(4) << row.plainNs << ","
+                      << row.prefetchNs << std::endl;
+        }
+    }
+    
+    // Reads records of `lengths` through the offsets+heap, padded-slot and
+    // inline small-string layouts in every pattern's order, taking either the
+    // first `prefixBytes` of each record or the whole record
+    void runVarlenSuite(const LengthDistribution& lengths, size_t prefixBytes) {
+        const int iterations = 5, warmup = 1;
+        const size_t n = indices.size();
+        
+        std::vector<std::vector<uint8_t>> records(n);
+        size_t totalBytes = 0, inlineCount = 0;
+        for (auto& record : records) {
+            record.resize(lengths.draw(rng));
+            for (auto& byte : record) byte = static_cast<uint8_t>(rng());
+            totalBytes += record.size();
+            inlineCount += record.size() <= InlineStrings::INLINE_BYTES;
+        }
+        OffsetsHeap offsets(records);
+        PaddedSlots padded(records);
+        InlineStrings inlined(records);
+        records.clear();
+        records.shrink_to_fit();
+        
+        std::cout << "Variable-Length Record Benchmark (C++)" << std::endl;
+        std::cout << n << " records, mean " << std::fixed << std::setprecision(1)
+                  << static_cast<double>(totalBytes) / n << " bytes, " << 100.0 * inlineCount / n << "% fit inline ("
+                  << InlineStrings::INLINE_BYTES << " bytes)" << std::endl;
+        std::cout << "Footprint: offsets " << offsets.bytes() / (1024 * 1024) << " MiB, padded "
+                  << padded.bytes() / (1024 * 1024) << " MiB (" << padded.slotBytes() << "-byte slots), inline "
+                  << inlined.bytes() / (1024 * 1024) << " MiB" << std::endl;
+        std::cout << "ns/record and GB/s of record bytes read\n" << std::endl;
+        
+        struct Row { std::string read, pattern, layout; double nsPerRecord, gbPerSec; };
+        std::vector<Row> rows;
+        volatile uint64_t sink = 0;
+        
+        for (size_t limit : {prefixBytes, std::numeric_limits<size_t>::max()}) {
+            const std::string read = limit == prefixBytes ? "first " + std::to_string(prefixBytes) + " bytes" : "whole record";
+            // Every pattern visits each record once, so the useful bytes are the same for all
+            double usefulBytes = 0.0;
+            for (size_t i = 0; i < n; i++) usefulBytes += static_cast<double>(std::min(limit, offsets.view(i).length));
+            
+            std::cout << read << std::endl;
+            std::cout << std::setw(12) << "Pattern" << std::setw(22) << "offsets" << std::setw(22) << "padded"
+                      << std::setw(22) << "inline" << std::endl;
+            for (const auto& pattern : patternNames()) {
+                generateNamedIndices(pattern);
+                std::cout << std::setw(12) << pattern;
+                auto measure = [&](const std::string& layout, const auto& store) {
+                    std::vector<double> times = timePasses([&]() {
+                        uint64_t sum = 0;
+                        for (size_t j = 0; j < n; j++) {
+                            RecordView view = store.view(indices[j] / 8);
+                            sum += record_checksum(view.data, std::min(limit, view.length));
+                        }
+                        sink = sum;
+                    }, iterations, warmup);
+                    double ms = times[iterations / 2];
+                    rows.push_back({read, pattern, layout, ms * 1e6 / n, usefulBytes / (ms * 1e6)});
+                    std::cout << std::setw(10) << std::setprecision(2) << rows.back().nsPerRecord << " ns "
+                              << std::setw(6) << rows.back().gbPerSec << " GB/s";
+                };
+                measure("offsets", offsets);
+                measure("padded", padded);
+                measure("inline", inlined);
+                std::cout << std::endl;
+            }
+            std::cout << std::endl;
+        }
+        
+        std::cout << "CSV_OUTPUT:" << std::endl;
+        std::cout << "Read,Pattern,Layout,Ns_per_record,GB_per_sec" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.read << "," << row.pattern << "," << row.layout << "," << std::setprecision(4)
+                      << row.nsPerRecord << "," << row.gbPerSec << std::endl;
+        }
+    }
+    
+    // Times a reuse-distance stream over one record per cache line of arr.
+    // Each pass first replays the setup (untimed) so the LRU stack the
+    // distances refer to is in place whatever the previous pass left
+    double timeReuseStream(ReuseDistribution& dist, size_t length) {
+        const int iterations = 3;
+        ReuseStream generated = generate_reuse_stream(dist, ARRAY_SIZE / 2, length, rng);
+        std::vector<size_t> setup(generated.setup.size()), stream(generated.stream.size());
+        for (size_t i = 0; i < setup.size(); i++) setup[i] = size_t(generated.setup[i]) * 2;
+        for (size_t i = 0; i < stream.size(); i++) stream[i] = size_t(generated.stream[i]) * 2;
+        
+        std::vector<double> times;
+        for (int i = 0; i <= iterations; i++) {
+            gatherPass(arr, setup);
+            double start = get_time();
+            gatherPass(arr, stream);
+            if (i > 0) times.push_back((get_time() - start) * 1e9 / stream.size()); // First pass is warmup
+        }
+        std::sort(times.begin(), times.end());
+        return times[iterations / 2];
+    }
+    
+    // Without a distribution, sweeps fixed reuse distances from 16 lines to
+    // arr's line count so the per-access time steps up as the reused
+    // footprint crosses each cache level; with one, times that distribution
+    // and lists the LRU miss ratio it implies at each cache size
+    void runReuseSuite(ReuseDistribution* dist) {
+        const size_t length = 1 << 20;
+        const size_t maxLines = ARRAY_SIZE / 2;
+        CacheTopology topo = detect_cache_topology();
+        const std::vector<std::pair<std::string, size_t>> levels = {{"L1", topo.l1d}, {"L2", topo.l2}, {"L3", topo.l3}};
+        auto levelFor = [&](size_t bytes) -> std::string {
+            for (const auto& level : levels) {
+                if (bytes <= level.second) return level.first;
+            }
+            return "DRAM";
+        };
+        
+        std::cout << "Reuse Distance Benchmark (C++)" << std::endl;
+        std::cout << "Detected L1d " << topo.l1d / 1024 << " KiB, L2 " << topo.l2 / 1024 << " KiB, L3 "
+                  << topo.l3 / 1024 << " KiB; one record per " << topo.lineSize << "-byte line, distances up to "
+                  << maxLines - 1 << " lines\n" << std::endl;
+        
+        if (dist) {
+            double ns = timeReuseStream(*dist, length);
+            std::cout << "ns/access: " << std::fixed << std::setprecision(3) << ns << std::endl;
+            std::cout << "LRU miss ratio implied by the distribution:" << std::endl;
+            for (const auto& level : levels) {
+                std::cout << std::setw(6) << level.first << ": " << std::setprecision(4)
+                          << dist->fractionAtLeast(level.second / topo.lineSize) << std::endl;
+            }
+            std::cout << "\nCSV_OUTPUT:" << std::endl;
+            std::cout << "Ns_per_access";
+            for (const auto& level : levels) std::cout << "," << level.first << "_miss_ratio";
+            std::cout << std::endl << std::setprecision(4) << ns;
+            for (const auto& level : levels) std::cout << "," << dist->fractionAtLeast(level.second / topo.lineSize);
+            std::cout << std::endl;
+            return;
+        }
+        
+        struct Row { size_t distance, footprintKiB; std::string level; double ns; };
+        std::vector<Row> rows;
+        std::cout << std::setw(12) << "Distance" << std::setw(14) << "Footprint" << std::setw(8) << "Fits"
+                  << std::setw(12) << "ns/access" << std::endl;
+        for (size_t distance = 16; distance < maxLines; distance *= 2) {
+            ReuseDistribution fixed = ReuseDistribution::fixed(distance);
+            size_t footprint = (distance + 1) * topo.lineSize;
+            rows.push_back({distance, footprint / 1024, levelFor(footprint), timeReuseStream(fixed, length)});
+            std::cout << std::setw(12) << distance << std::setw(10) << rows.back().footprintKiB << " KiB"
+                      << std::setw(8) << rows.back().level << std::setw(12) << std::fixed << std::setprecision(3)
+                      << rows.back().ns << std::endl;
+        }
+        
+        // Step at each capacity: last distance that fits vs first that does not
+        std::cout << std::endl;
+        for (size_t r = 1; r < rows.size(); r++) {
+            if (rows[r].level == rows[r - 1].level) continue;
+            std::cout << "Crossing " << rows[r - 1].level << " -> " << rows[r].level << ": " << std::setprecision(3)
+                      << rows[r - 1].ns << " -> " << rows[r].ns << " ns (" << std::setprecision(2)
+                      << rows[r].ns / rows[r - 1].ns << "x)" << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Distance_lines,Footprint_KiB,Fits_in,Ns_per_access" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.distance << "," << row.footprintKiB << "," << row.level << "," << std::setprecision(4)
+                      << row.ns << std::endl;
+        }
+    }
+    
+    // For each pattern (plus Zipf 0.99) over working sets from 1K to 512K
+    // lines: measured ns/access, next to the SHARDS miss ratio curve of the
+    // same stream repeated to `accesses` references. Line ids are record
+    // index * sizeof(DataStruct) / line size, as the hardware sees them
+    void runMrcSuite(double rate, size_t accesses) {
+        const int iterations = 5, warmup = 1;
+        const size_t accessesPerPass = 1 << 20;
+        CacheTopology topo = detect_cache_topology();
+        std::vector<size_t> curveSizes; // Cache sizes in lines, 16 lines to 4x the largest working set
+        for (size_t lines = 16; lines <= (size_t(4) << 19); lines *= 2) curveSizes.push_back(lines);
+        const std::vector<std::pair<std::string, size_t>> levels = {
+            {"L1", topo.l1d / topo.lineSize}, {"L2", topo.l2 / topo.lineSize}, {"L3", topo.l3 / topo.lineSize}};
+        std::vector<size_t> levelSizes;
+        for (const auto& level : levels) levelSizes.push_back(level.second);
+        
+        std::cout << "Miss Ratio Curve Benchmark (C++)" << std::endl;
+        std::cout << "SHARDS sampling rate " << rate << ", " << accesses << " references per stream; "
+                  << "predicted miss ratios are for fully associative LRU caches of the detected sizes\n" << std::endl;
+        std::cout << std::setw(12) << "Pattern" << std::setw(10) << "Lines" << std::setw(12) << "ns/access";
+        for (const auto& level : levels) std::cout << std::setw(10) << level.first + " miss";
+        std::cout << std::setw(14) << "Analysis" << std::endl;
+        
+        struct Row { std::string pattern; size_t lines; double ns; std::vector<double> curve; };
+        std::vector<Row> rows;
+        const std::vector<size_t> fullIndices = indices;
+        std::vector<std::string> streams = patternNames();
+        streams.push_back("Zipf");
+        volatile uint64_t sink = 0;
+        
+        for (const auto& pattern : streams) {
+            for (size_t slots = 1 << 10; slots <= (1 << 19); slots *= 8) {
+                indices.assign(slots, 0);
+                if (pattern == "Zipf") generateZipfIndices(0.99);
+                else generateNamedIndices(pattern);
+                
+                const size_t reps = std::max<size_t>(1, accessesPerPass / slots);
+                std::vector<double> times = timePasses([&]() {
+                    uint64_t sum = 0;
+                    for (size_t r = 0; r < reps; r++) {
+                        for (size_t j = 0; j < slots; j++) sum += arr[indices[j]].a;
+                    }
+                    sink = sum;
+                }, iterations, warmup);
+                double ns = times[iterations / 2] * 1e6 / (reps * slots);
+                
+                ShardsAnalyzer analyzer(rate);
+                double start = get_time();
+                for (size_t j = 0; j < accesses; j++) {
+                    analyzer.access(indices[j % slots] * sizeof(DataStruct) / topo.lineSize);
+                }
+                double analysisSeconds = get_time() - start;
+                std::vector<double> predicted = analyzer.missRatioCurve(levelSizes);
+                rows.push_back({pattern, slots, ns, analyzer.missRatioCurve(curveSizes)});
+                
+                std::cout << std::setw(12) << pattern << std::setw(10) << slots << std::setw(12) << std::fixed
+                          << std::setprecision(3) << ns;
+                for (double ratio : predicted) std::cout << std::setw(10) << std::setprecision(4) << ratio;
+                std::cout << std::setw(8) << std::setprecision(0) << accesses / analysisSeconds / 1e6 << " M/s" << std::endl;
+            }
+        }
+        indices = fullIndices;
+        
+        // Sampling error against exact (rate 1) distances for the Zipf stream
+        // at the largest working set, where the curve is least trivial
+        {
+            indices.assign(1 << 19, 0);
+            generateZipfIndices(0.99);
+            const size_t n = std::min<size_t>(accesses, 1 << 23);
+            ShardsAnalyzer exact(1.0), sampled(rate);
+            for (size_t j = 0; j < n; j++) {
+                uint64_t line = indices[j % indices.size()] * sizeof(DataStruct) / topo.lineSize;
+                exact.access(line);
+                sampled.access(line);
+            }
+            std::vector<double> a = exact.missRatioCurve(curveSizes), b = sampled.missRatioCurve(curveSizes);
+            // Sampled distances move in steps of 1 / rate lines, which bounds the smallest usable size
+            double worst = 0.0;
+            for (size_t i = 0; i < a.size(); i++) {
+                if (curveSizes[i] >= 1.0 / rate) worst = std::max(worst, std::abs(a[i] - b[i]));
+            }
+            std::cout << "\nSampling check (Zipf, " << n << " references): max |exact - sampled| miss ratio "
+                      << std::setprecision(4) << worst << " for caches of at least " << std::setprecision(0)
+                      << std::ceil(1.0 / rate) << " lines" << std::endl;
+            indices = fullIndices;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Working_set_lines,Ns_per_access,Cache_lines,Predicted_miss_ratio" << std::endl;
+        for (const auto& row : rows) {
+            for (size_t i = 0; i < curveSizes.size(); i++) {
+                std::cout << row.pattern << "," << row.lines << "," << std::setprecision(4) << row.ns << ","
+                          << curveSizes[i] << "," << row.curve[i] << std::endl;
+            }
+        }
+    }
+    
+    // Fits a StrideModel to each input stream (a trace, or every pattern plus
+    // Clustered and Zipf 0.99), generates a synthetic stream of `length`
+    // accesses and compares the two: stride-class mix, measured gather time
+    // and exact LRU miss ratios at the detected cache sizes
+    int runStrideModelSuite(const std::string& tracePath, size_t length) {
+        const int iterations = 5, warmup = 1;
+        CacheTopology topo = detect_cache_topology();
+        const std::vector<std::pair<std::string, size_t>> levels = {
+            {"L1", topo.l1d / topo.lineSize}, {"L2", topo.l2 / topo.lineSize}, {"L3", topo.l3 / topo.lineSize}};
+        std::vector<size_t> levelSizes;
+        for (const auto& level : levels) levelSizes.push_back(level.second);
+        
+        // Input streams as record indices into arr
+        std::vector<std::pair<std::string, std::vector<size_t>>> inputs;
+        if (!tracePath.empty()) {
+            std::vector<uint64_t> addresses;
+            std::string error;
+            if (!read_address_trace(tracePath, addresses, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            uint64_t base = *std::min_element(addresses.begin(), addresses.end());
+            std::vector<size_t> records(addresses.size());
+            for (size_t i = 0; i < addresses.size(); i++) {
+                records[i] = static_cast<size_t>((addresses[i] - base) / sizeof(DataStruct) % ARRAY_SIZE);
+            }
+            inputs.push_back({"trace", records});
+        } else {
+            for (const auto& pattern : patternNames()) {
+                generateNamedIndices(pattern);
+                inputs.push_back({pattern, indices});
+            }
+            generateClusteredIndices();
+            inputs.push_back({"Clustered", indices});
+            generateZipfIndices(0.99);
+            inputs.push_back({"Zipf", indices});
+        }
+        
+        std::cout << "Stride Model Synthesizer (C++)" << std::endl;
+        std::cout << "Up to " << StrideModel::CLASSES_PER_KIND << " delta-1 and delta-2 stride classes, Markov "
+                  << "transitions, 64K popularity regions; miss ratios are exact LRU (stack distance)\n" << std::endl;
+        
+        struct Row { std::string input, stream; size_t length; double ns; std::vector<double> missRatios; };
+        std::vector<Row> rows;
+        
+        for (const auto& input : inputs) {
+            StrideModel model;
+            model.fit(input.second, ARRAY_SIZE);
+            const std::vector<size_t> synthetic = model.generate(length ? length : input.second.size(), rng);
+            
+            std::vector<double> original = model.classHistogram(input.second), generated = model.classHistogram(synthetic);
+            double variation = 0.0;
+            for (size_t c = 0; c < original.size(); c++) variation += std::abs(original[c] - generated[c]) / 2;
+            std::cout << input.first << ": " << model.classCount() << " classes, total variation "
+                      << std::fixed << std::setprecision(4) << variation << " (";
+            for (size_t c = 0; c < model.classCount(); c++) {
+                std::cout << (c ? ", " : "") << model.className(c) << " " << std::setprecision(3) << original[c];
+            }
+            std::cout << ")" << std::endl;
+            
+            for (const std::vector<size_t>* stream : {&input.second, &synthetic}) {
+                std::vector<double> times = timePasses([&]() { gatherPass(arr, *stream); }, iterations, warmup);
+                ShardsAnalyzer analyzer(1.0);
+                for (size_t record : *stream) analyzer.access(record * sizeof(DataStruct) / topo.lineSize);
+                rows.push_back({input.first, stream == &synthetic ? "synthetic" : "original", stream->size(),
+                                times[iterations / 2] * 1e6 / stream->size(), analyzer.missRatioCurve(levelSizes)});
+                const Row& row = rows.back();
+                std::cout << std::setw(12) << row.stream << ": " << std::setprecision(3) << std::setw(8) << row.ns
+                          << " ns/access, miss ratio";
+                for (size_t l = 0; l < levels.size(); l++) {
+                    std::cout << " " << levels[l].first << " " << std::setprecision(4) << row.missRatios[l];
+                }
+                std::cout << std::endl;
+            }
+            const Row& a = rows[rows.size() - 2];
+            const Row& b = rows.back();
+            if (a.ns > 0.0) {
+                std::cout << std::setw(12) << "synth/orig" << ": " << std::setprecision(2) << std::setw(8)
+                          << b.ns / a.ns << "x time" << std::endl;
+            }
+            std::cout << std::endl;
+        }
+        
+        std::cout << "CSV_OUTPUT:" << std::endl;
+        std::cout << "Input,Stream,Length,Ns_per_access";
+        for (const auto& level : levels) std::cout << "," << level.first << "_miss_ratio";
+        std::cout << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.input << "," << row.stream << "," << row.length << "," << std::setprecision(4) << row.ns;
+            for (double ratio : row.missRatios) std::cout << "," << ratio;
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+    
+    // Runs every generator through PatternClassifier in 4096-index windows:
+    // the share of windows given the generator's label, the mean confidence,
+    // the most common wrong label, and classification throughput in GB/s of
+    // 8-byte indices
+    void runClassifierSuite() {
+        const int iterations = 5, warmup = 1;
+        const size_t n = indices.size();
+        PatternClassifier classifier(4096, 64);
+        volatile double sink = 0.0;
+        
+        struct Stream { std::string name, expected; unsigned streams; std::vector<size_t> order; };
+        std::vector<Stream> streams;
+        const std::map<std::string, std::pair<std::string, unsigned>> expected = {
+            {"Sequential", {"sequential", 1}}, {"Backward", {"backward", 1}}, {"Interleaved", {"interleaved", 2}},
+            {"Bouncing", {"bouncing", 2}}, {"Random", {"random", 1}}, {"Clustered", {"clustered", 1}}};
+        for (const auto& entry : expected) {
+            generateNamedIndices(entry.first);
+            streams.push_back({entry.first, entry.second.first, entry.second.second, indices});
+        }
+        generateZipfIndices(0.99);
+        streams.push_back({"Zipf", "random", 1, indices});
+        // A large constant stride (one record per 4 KiB page) and four interleaved ascending streams
+        std::vector<size_t> strided(n), fourWay(n);
+        for (size_t i = 0; i < n; i++) {
+            strided[i] = i * 128 % ARRAY_SIZE + i * 128 / ARRAY_SIZE;
+            fourWay[i] = (i % 4) * (ARRAY_SIZE / 4) + (i / 4) * 8;
+        }
+        streams.push_back({"Strided", "strided", 1, strided});
+        streams.push_back({"4-way", "interleaved", 4, fourWay});
+        
+        std::cout << "Access Pattern Classifier (C++)" << std::endl;
+        std::cout << classifier.window() << "-index windows, short hop <= 64 elements\n" << std::endl;
+        std::cout << std::setw(12) << "Stream" << std::setw(16) << "Expected" << std::setw(10) << "Correct"
+                  << std::setw(12) << "Confidence" << std::setw(24) << "Most common miss" << std::setw(10) << "GB/s"
+                  << std::endl;
+        
+        struct Row { std::string stream, expected; double correct, confidence, gbPerSec; };
+        std::vector<Row> rows;
+        for (const auto& stream : streams) {
+            std::map<std::string, size_t> wrong;
+            size_t windows = 0, correct = 0;
+            double confidence = 0.0;
+            classifier.push(stream.order.data(), stream.order.size(), [&](const PatternLabel& label) {
+                std::string name = access_pattern_name(label.pattern);
+                if (label.pattern == AccessPattern::Interleaved) name += "/" + std::to_string(label.streams);
+                windows++;
+                confidence += label.confidence;
+                if (name == stream.expected || name == stream.expected + "/" + std::to_string(stream.streams)) correct++;
+                else wrong[name]++;
+            });
+            
+            std::vector<double> times = timePasses([&]() {
+                double total = 0.0;
+                classifier.push(stream.order.data(), stream.order.size(),
+                                [&](const PatternLabel& label) { total += label.confidence; });
+                sink = total;
+            }, iterations, warmup);
+            double gbPerSec = stream.order.size() * sizeof(size_t) / (times[iterations / 2] * 1e6);
+            
+            std::string miss = "-";
+            size_t missCount = 0;
+            for (const auto& entry : wrong) {
+                if (entry.second > missCount) {
+                    miss = entry.first;
+                    missCount = entry.second;
+                }
+            }
+            std::string label = stream.expected + (stream.expected == "interleaved" ? "/" + std::to_string(stream.streams) : "");
+            rows.push_back({stream.name, label, static_cast<double>(correct) / windows, confidence / windows, gbPerSec});
+            std::cout << std::setw(12) << stream.name << std::setw(16) << label << std::setw(9) << std::fixed
+                      << std::setprecision(1) << 100.0 * rows.back().correct << "%" << std::setw(12)
+                      << std::setprecision(3) << rows.back().confidence << std::setw(24) << miss
+                      << std::setw(10) << std::setprecision(2) << gbPerSec << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Stream,Expected,Correct_fraction,Mean_confidence,GB_per_sec" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.stream << "," << row.expected << "," << std::setprecision(4) << row.correct << ","
+                      << row.confidence << "," << row.gbPerSec << std::endl;
+        }
+    }
+    
+    // Precise load sampling (PEBS load latency / IBS) of the gather pass
+    // sum += arr[indices[j]].a under each pattern. Samples whose address lies
+    // in arr are grouped by data source with latency percentiles, and binned
+    // into a 64-bucket address heatmap over arr. IBS samples every op, so its
+    // samples whose mem_op is not a load are dropped first
+    void runLatencySuite(uint64_t period) {
+        const int iterations = 5, warmup = 1, sampledPasses = 4;
+        const size_t buckets = 64;
+        const uint64_t base = reinterpret_cast<uint64_t>(arr.data());
+        const uint64_t bytes = ARRAY_SIZE * sizeof(DataStruct);
+        const char* ramp = " .:-=+*#%@";
+        volatile uint64_t sink = 0;
+        
+        LoadLatencySampler sampler;
+        std::string error;
+        bool sampling = sampler.open(period, error);
+        
+        std::cout << "Load Latency Sampling Benchmark (C++)" << std::endl;
+        if (sampling) {
+            std::cout << sampler.method() << ", one sample per " << period
+                      << (sampler.samplesAllOps() ? " ops of any kind (non-loads dropped), " : " loads, ") << sampledPasses
+                      << " passes per pattern; latency in cycles; heatmap spans arr (" << bytes / (1024 * 1024)
+                      << " MiB, " << bytes / buckets / 1024 << " KiB per column)\n" << std::endl;
+        } else {
+            std::cout << "Load sampling unavailable: " << error << "; timings only\n" << std::endl;
+        }
+        
+        auto pass = [&]() {
+            uint64_t sum = 0;
+            for (size_t j = 0; j < indices.size(); j++) {
+                sum += arr[indices[j]].a;
+                keep_in_register(sum);
+            }
+            sink = sum;
+        };
+        
+        struct Stats { size_t samples; double mean, p50, p90; };
+        auto summarize = [](std::vector<uint64_t>& weights) {
+            Stats stats{weights.size(), 0.0, 0.0, 0.0};
+            if (weights.empty()) return stats;
+            std::sort(weights.begin(), weights.end());
+            for (uint64_t w : weights) stats.mean += static_cast<double>(w);
+            stats.mean /= weights.size();
+            stats.p50 = static_cast<double>(weights[weights.size() / 2]);
+            stats.p90 = static_cast<double>(weights[weights.size() * 9 / 10]);
+            return stats;
+        };
+        
+        struct Row { std::string pattern; double ns; std::string group, key; Stats stats; double share; };
+        std::vector<Row> rows;
+        for (const auto& pattern : patternNames()) {
+            generateNamedIndices(pattern);
+            std::vector<double> times = timePasses(pass, iterations, warmup);
+            double ns = times[iterations / 2] * 1e6 / indices.size();
+            if (!sampling) {
+                rows.push_back({pattern, ns, "n/a", "", {0, 0.0, 0.0, 0.0}, 0.0});
+                std::cout << std::setw(12) << pattern << std::setw(10) << std::fixed << std::setprecision(3)
+                          << ns << " ns/access" << std::endl;
+                continue;
+            }
+            
+            std::vector<LoadSample> samples;
+            uint64_t lostBefore = sampler.lost();
+            for (int p = 0; p < sampledPasses; p++) {
+                sampler.start();
+                pass();
+                sampler.stop();
+                sampler.drain(samples);
+            }
+            
+            std::vector<std::vector<uint64_t>> bySource(static_cast<size_t>(DataSource::Other) + 1);
+            std::vector<std::vector<uint64_t>> byBucket(buckets);
+            size_t inArr = 0, nonLoads = 0;
+            for (const auto& sample : samples) {
+                if (sampler.samplesAllOps() && !is_load_sample(sample.dataSrc)) {
+                    nonLoads++;
+                    continue;
+                }
+                if (sample.addr < base || sample.addr >= base + bytes) continue;
+                DataSource source = decode_data_source(sample.dataSrc);
+                inArr++;
+                bySource[static_cast<size_t>(source)].push_back(sample.weight);
+                byBucket[(sample.addr - base) * buckets / bytes].push_back(sample.weight);
+            }
+            
+            std::cout << pattern << " (" << std::fixed << std::setprecision(3) << ns << " ns/access, " << inArr
+                      << " samples in arr, " << samples.size() - inArr - nonLoads << " elsewhere, ";
+            if (sampler.samplesAllOps()) std::cout << nonLoads << " non-load ops, ";
+            std::cout << sampler.lost() - lostBefore << " lost)" << std::endl;
+            std::cout << std::setw(10) << "Source" << std::setw(10) << "Samples" << std::setw(9) << "Share"
+                      << std::setw(10) << "Mean" << std::setw(8) << "P50" << std::setw(8) << "P90" << std::endl;
+            for (size_t s = 0; s < bySource.size(); s++) {
+                Stats stats = summarize(bySource[s]);
+                if (stats.samples == 0) continue;
+                double share = static_cast<double>(stats.samples) / inArr;
+                const char* name = data_source_name(static_cast<DataSource>(s));
+                rows.push_back({pattern, ns, "source", name, stats, share});
+                std::cout << std::setw(10) << name << std::setw(10) << stats.samples << std::setw(8)
+                          << std::setprecision(1) << 100.0 * share << "%" << std::setw(10) << stats.mean
+                          << std::setw(8) << std::setprecision(0) << stats.p50 << std::setw(8) << stats.p90
+                          << std::endl;
+            }
+            
+            // Heatmap: sample density per column of arr, scaled to the busiest column
+            size_t busiest = 1;
+            for (const auto& bucket : byBucket) busiest = std::max(busiest, bucket.size());
+            std::string heat;
+            for (size_t b = 0; b < buckets; b++) {
+                Stats stats = summarize(byBucket[b]);
+                heat += ramp[(stats.samples * 9 + busiest - 1) / busiest];
+                rows.push_back({pattern, ns, "bucket", std::to_string(b), stats,
+                                inArr ? static_cast<double>(stats.samples) / inArr : 0.0});
+            }
+            std::cout << std::setw(10) << "heatmap" << " |" << heat << "|\n" << std::endl;
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Ns_per_access,Group,Key,Samples,Share,Mean_cycles,P50_cycles,P90_cycles" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.pattern << "," << std::setprecision(4) << row.ns << "," << row.group << ",";
+            if (row.group == "n/a") {
+                std::cout << "n/a,n/a,n/a,n/a,n/a,n/a" << std::endl;
+                continue;
+            }
+            std::cout << row.key << "," << row.stats.samples << "," << row.share << "," << row.stats.mean << ","
+                      << row.stats.p50 << "," << row.stats.p90 << std::endl;
+        }
+    }
+    
+    // Top-down level 1 and 2 of the gather pass sum += arr[indices[j]].a
+    // under each pattern, as shares of all issue slots, with stacked bars:
+    // F frontend, S bad speculation, R retiring, M memory bound, C core bound
+    // at level 1, and 1/2/3/D/W for L1/L2/L3/DRAM/store bound within memory
+    void runTopdownSuite(const TopdownTable* table) {
+        const int iterations = 5, warmup = 1, barWidth = 50;
+        volatile uint64_t sink = 0;
+        
+        TopdownCollector collector;
+        std::string error = "no event table for this CPU (use --cpu)";
+        bool counting = table && collector.open(*table, error);
+        
+        std::cout << "Top-Down Microarchitecture Analysis (C++)" << std::endl;
+        if (counting) {
+            std::cout << "Event table " << table->name << " (" << table->width << " slots/cycle); "
+                      << "% of issue slots, memory split by stall cycles"
+                      << (std::string(table->vendor) == "amd" ? " (AMD: by L1D fill source)" : "") << "\n" << std::endl;
+        } else {
+            std::cout << "Top-down counters unavailable: " << error << "; timings only\n" << std::endl;
+        }
+        
+        auto pass = [&]() {
+            uint64_t sum = 0;
+            for (size_t j = 0; j < indices.size(); j++) {
+                sum += arr[indices[j]].a;
+                keep_in_register(sum);
+            }
+            sink = sum;
+        };
+        
+        // Stacked bar of `shares` (fractions) drawn with one symbol each
+        auto bar = [&](const std::vector<double>& shares, const std::string& symbols) {
+            std::string out;
+            double cumulative = 0.0;
+            for (size_t i = 0; i < shares.size(); i++) {
+                if (std::isnan(shares[i])) continue;
+                cumulative += shares[i];
+                size_t end = static_cast<size_t>(std::lround(std::min(1.0, cumulative) * barWidth));
+                if (end > out.size()) out.append(end - out.size(), symbols[i]);
+            }
+            return out + std::string(barWidth - out.size(), ' ');
+        };
+        auto percent = [](double x) {
+            std::ostringstream s;
+            if (std::isnan(x)) s << "n/a";
+            else s << std::fixed << std::setprecision(1) << 100.0 * x;
+            return s.str();
+        };
+        
+        struct Row { std::string pattern; double ns, coverage; TopdownBreakdown b; };
+        std::vector<Row> rows;
+        std::cout << std::setw(12) << "Pattern" << std::setw(9) << "ns/acc" << std::setw(8) << "FE" << std::setw(8)
+                  << "BadSpec" << std::setw(8) << "Retire" << std::setw(8) << "Backend" << std::setw(8) << "Memory"
+                  << std::setw(8) << "Core" << std::setw(8) << "L1" << std::setw(8) << "L2" << std::setw(8) << "L3"
+                  << std::setw(8) << "DRAM" << std::setw(8) << "Store" << std::setw(8) << "Cover" << std::endl;
+        for (const auto& pattern : patternNames()) {
+            generateNamedIndices(pattern);
+            collector.start();
+            std::vector<double> times = timePasses(pass, iterations, warmup);
+            collector.stop();
+            const double nan = std::nan("");
+            TopdownBreakdown b = counting ? collector.breakdown()
+                                          : TopdownBreakdown{nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan};
+            rows.push_back({pattern, times[iterations / 2] * 1e6 / indices.size(),
+                            counting ? collector.coverage() : nan, b});
+            std::cout << std::setw(12) << pattern << std::setw(9) << std::fixed << std::setprecision(3) << rows.back().ns;
+            for (double x : {b.frontend, b.badSpeculation, b.retiring, b.backend, b.memory, b.core,
+                             b.l1, b.l2, b.l3, b.dram, b.store, rows.back().coverage}) {
+                std::cout << std::setw(8) << percent(x);
+            }
+            std::cout << std::endl;
+        }
+        
+        if (counting) {
+            std::cout << "\nLevel 1 (F frontend, S bad speculation, R retiring, M memory, C core)" << std::endl;
+            for (const auto& row : rows) {
+                const TopdownBreakdown& b = row.b;
+                std::cout << std::setw(12) << row.pattern << " |"
+                          << bar({b.frontend, b.badSpeculation, b.retiring, b.memory, b.core}, "FSRMC") << "|"
+                          << std::endl;
+            }
+            std::cout << "\nMemory bound (1 L1, 2 L2, 3 L3, D DRAM, W store), full width = 100% of slots" << std::endl;
+            for (const auto& row : rows) {
+                const TopdownBreakdown& b = row.b;
+                std::cout << std::setw(12) << row.pattern << " |" << bar({b.l1, b.l2, b.l3, b.dram, b.store}, "123DW")
+                          << "| " << percent(b.memory) << "%" << std::endl;
+            }
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Ns_per_access,Frontend,Bad_speculation,Retiring,Backend,Memory,Core,"
+                     "L1,L2,L3,DRAM,Store,Coverage" << std::endl;
+        for (const auto& row : rows) {
+            const TopdownBreakdown& b = row.b;
+            std::cout << row.pattern << "," << std::setprecision(4) << row.ns;
+            for (double x : {b.frontend, b.badSpeculation, b.retiring, b.backend, b.memory, b.core,
+                             b.l1, b.l2, b.l3, b.dram, b.store, row.coverage}) {
+                std::cout << ",";
+                if (std::isnan(x)) std::cout << "n/a";
+                else std::cout << x;
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    // DRAM traffic per pattern from the memory controllers' CAS counters.
+    // Two kernels: read (sum += a, 4 useful bytes per access) and update
+    // (a += 1, 4 bytes read and 4 written, so dirty lines are written back).
+    // Read B/line compares DRAM reads with the lines the pattern touches:
+    // above 1 means prefetchers fetched lines the pass never used
+    void runDramTrafficSuite() {
+        const int iterations = 5, warmup = 1;
+        const double lineBytes = 64.0;
+        volatile uint64_t sink = 0;
+        
+        UncoreImcCounters imc;
+        std::string error;
+        bool counting = imc.open(error);
+        
+        // Other activity on the socket shows up too: measure it while idle and subtract
+        double idleBytesPerSec = 0.0;
+        if (counting) {
+            imc.start();
+            double start = get_time();
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            double elapsed = get_time() - start;
+            imc.stop();
+            idleBytesPerSec = (imc.readBytes() + imc.writeBytes()) / elapsed;
+        }
+        
+        std::cout << "DRAM Traffic Benchmark (C++)" << std::endl;
+        if (counting) {
+            std::cout << imc.source() << ", " << imc.channels() << " channel(s); idle socket traffic "
+                      << std::fixed << std::setprecision(3) << idleBytesPerSec / 1e9
+                      << " GB/s subtracted pro rata from reads and writes" << std::endl;
+        } else {
+            std::cout << "DRAM counters unavailable: " << error << "; timings only" << std::endl;
+        }
+        std::cout << "B/B: DRAM bytes per useful byte (4 read, plus 4 written by update, per access); "
+                     "B/line: DRAM read bytes per byte of the lines touched\n" << std::endl;
+        std::cout << std::setw(12) << "Pattern" << std::setw(8) << "Kernel" << std::setw(10) << "ns/acc"
+                  << std::setw(12) << "Read GB/s" << std::setw(12) << "Write GB/s" << std::setw(12) << "Read B/B"
+                  << std::setw(12) << "Write B/B" << std::setw(12) << "Read B/line" << std::endl;
+        
+        struct Row { std::string pattern, kernel; double ns, readGbPerSec, writeGbPerSec, readPerUseful, writePerUseful, readPerLine; };
+        std::vector<Row> rows;
+        for (const auto& pattern : patternNames()) {
+            generateNamedIndices(pattern);
+            std::vector<size_t> lines(indices.size());
+            for (size_t j = 0; j < indices.size(); j++) lines[j] = indices[j] * sizeof(DataStruct) / 64;
+            std::sort(lines.begin(), lines.end());
+            const double touchedLines = static_cast<double>(std::unique(lines.begin(), lines.end()) - lines.begin());
+            
+            for (const std::string kernel : {"read", "update"}) {
+                auto pass = [&]() {
+                    if (kernel == "read") {
+                        uint64_t sum = 0;
+                        for (size_t j = 0; j < indices.size(); j++) {
+                            sum += arr[indices[j]].a;
+                            keep_in_register(sum);
+                        }
+                        sink = sum;
+                    } else {
+                        for (size_t j = 0; j < indices.size(); j++) arr[indices[j]].a += 1;
+                    }
+                };
+                imc.start();
+                double start = get_time();
+                std::vector<double> times = timePasses(pass, iterations, warmup);
+                double elapsed = get_time() - start;
+                imc.stop();
+                
+                // Counters cover every pass, warmup included
+                const double passes = iterations + warmup;
+                const double idle = idleBytesPerSec * elapsed / 2; // Split evenly between reads and writes
+                auto perPass = [&](double bytes) { return counting ? std::max(0.0, bytes - idle) / passes : bytes; };
+                const double readBytes = perPass(imc.readBytes()), writeBytes = perPass(imc.writeBytes());
+                const double accesses = static_cast<double>(indices.size());
+                rows.push_back({pattern, kernel, times[iterations / 2] * 1e6 / accesses,
+                                readBytes * passes / elapsed / 1e9, writeBytes * passes / elapsed / 1e9,
+                                readBytes / (4.0 * accesses),
+                                kernel == "update" ? writeBytes / (4.0 * accesses) : std::nan(""),
+                                readBytes / (touchedLines * lineBytes)});
+                
+                const Row& row = rows.back();
+                std::cout << std::setw(12) << pattern << std::setw(8) << kernel << std::setw(10) << std::fixed
+                          << std::setprecision(3) << row.ns;
+                for (double x : {row.readGbPerSec, row.writeGbPerSec, row.readPerUseful, row.writePerUseful,
+                                 row.readPerLine}) {
+                    std::cout << std::setw(12);
+                    if (std::isnan(x)) std::cout << "n/a";
+                    else std::cout << std::setprecision(2) << x;
+                }
+                std::cout << std::endl;
+            }
+        }
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Pattern,Kernel,Ns_per_access,Read_GB_per_sec,Write_GB_per_sec,Read_bytes_per_useful_byte,"
+                     "Write_bytes_per_useful_byte,Read_bytes_per_touched_line_byte" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.pattern << "," << row.kernel << "," << std::setprecision(4) << row.ns;
+            for (double x : {row.readGbPerSec, row.writeGbPerSec, row.readPerUseful, row.writePerUseful,
+                             row.readPerLine}) {
+                std::cout << ",";
+                if (std::isnan(x)) std::cout << "n/a";
+                else std::cout << x;
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    struct SortRow { std::string layout, input, algorithm; double nsPerElement, gbPerSec; };
+    
+    // Times every sort algorithm on sorted, reversed and random copies of `records`
+    template<typename T, typename KeyFn>
+    void runSortsOn(const std::string& layout, std::vector<T> records, KeyFn key,
+                    unsigned threads, std::vector<SortRow>& rows) {
+        auto less = [&](const T& x, const T& y) { return key(x) < key(y); };
+        
+        // Sorted and reversed inputs walk memory like the Sequential and Backward patterns
+        std::vector<std::pair<std::string, std::vector<T>>> inputs;
+        std::vector<T> ascending(records);
+        std::sort(ascending.begin(), ascending.end(), less);
+        inputs.push_back({"Sequential", ascending});
+        inputs.push_back({"Backward", std::vector<T>(ascending.rbegin(), ascending.rend())});
+        inputs.push_back({"Random", std::move(records)});
+        ascending.clear();
+        ascending.shrink_to_fit();
+        
+        std::vector<std::pair<std::string, std::function<void(std::vector<T>&, std::vector<T>&)>>> algorithms = {
+            {"std::sort", [&](std::vector<T>& v, std::vector<T>&) { std::sort(v.begin(), v.end(), less); }},
+            {"std::stable_sort", [&](std::vector<T>& v, std::vector<T>&) { std::stable_sort(v.begin(), v.end(), less); }},
+            {"LSD radix", [&](std::vector<T>& v, std::vector<T>& tmp) { lsd_radix_sort(v, tmp, key); }},
+            {"MSD radix+WC", [&](std::vector<T>& v, std::vector<T>& tmp) { msd_radix_sort_wc(v, tmp, key); }},
+            {"pdqsort", [&](std::vector<T>& v, std::vector<T>&) { pdq_sort(v, key); }},
+            {"sample sort", [&](std::vector<T>& v, std::vector<T>& tmp) { parallel_sample_sort(v, tmp, key, threads); }},
+        };
+        
+        const int iterations = 3, warmup = 1;
+        std::vector<T> work, tmp(inputs[0].second.size());
+        for (const auto& input : inputs) {
+            for (const auto& algorithm : algorithms) {
+                std::vector<double> times;
+                for (int i = 0; i < warmup + iterations; i++) {
+                    work = input.second; // Restoring the input is not timed
+                    double start = get_time();
+                    algorithm.second(work, tmp);
+                    double end = get_time();
+                    if (i >= warmup) times.push_back((end - start) * 1000.0);
+                }
+                if (!std::is_sorted(work.begin(), work.end(), less)) {
+                    std::cerr << "Warning: " << algorithm.first << " left " << layout << "/" << input.first
+                              << " unsorted" << std::endl;
+                }
+                
+                std::sort(times.begin(), times.end());
+                double median_time = times[iterations / 2];
+                double n = static_cast<double>(work.size());
+                rows.push_back({layout, input.first, algorithm.first, median_time * 1e6 / n,
+                                n * sizeof(T) / (median_time * 1e-3) / 1e9});
+                std::cout << std::setw(10) << layout << std::setw(12) << input.first
+                          << std::setw(18) << algorithm.first << ": "
+                          << std::setw(8) << std::fixed << std::setprecision(2) << rows.back().nsPerElement << " ns/elem"
+                          << std::setw(8) << rows.back().gbPerSec << " GB/s" << std::endl;
+            }
+        }
+    }
+    
+    // Sort benchmark over arr keyed by .a, as 8-byte key-index pairs and as full records
+    void runSortSuite(size_t elements, unsigned threads) {
+        elements = std::min(elements, arr.size());
+        std::cout << "Sort Benchmark (C++)" << std::endl;
+        std::cout << "Sorting " << elements << " records by .a, " << threads
+                  << " threads for sample sort; GB/s = record bytes sorted per second\n" << std::endl;
+        
+        std::vector<SortRow> rows;
+        std::vector<KeyIndex> pairs(elements);
+        for (size_t i = 0; i < elements; i++) pairs[i] = {arr[i].a, static_cast<uint32_t>(i)};
+        runSortsOn("key-index", std::move(pairs), [](const KeyIndex& r) { return r.key; }, threads, rows);
+        runSortsOn("record", std::vector<DataStruct>(arr.begin(), arr.begin() + elements),
+                   [](const DataStruct& r) { return r.a; }, threads, rows);
+        
+        std::cout << "\nCSV_OUTPUT:" << std::endl;
+        std::cout << "Layout,Input,Algorithm,Ns_per_element,GB_per_s" << std::endl;
+        for (const auto& row : rows) {
+            std::cout << row.layout << "," << row.input << "," << row.algorithm << ","
+                      << std::setprecision(3) << row.nsPerElement << "," << row.gbPerSec << std::endl;
+        }
+    }
+    
+    // Handles one experiment spec from a server client and returns a JSON reply
+    std::string handleRequest(const std::string& line, int defaultCore, bool& running) {
+        std::map<std::string, std::string> spec;
+        std::ostringstream reply;
+        if (!parse_flat_json(line, spec)) {
+            return "{\"error\": \"malformed request\"}";
+        }
+        
+        std::string cmd = spec.count("cmd") ? spec["cmd"] : "run";
+        if (cmd == "shutdown") {
+            running = false;
+            return "{\"status\": \"shutting down\"}";
+        }
+        if (cmd == "info") {
+            reply << "{\"array_elements\": " << ARRAY_SIZE
+                  << ", \"element_bytes\": " << sizeof(DataStruct)
+                  << ", \"accesses\": " << indices.size()
+                  << ", \"patterns\": [";
+            for (size_t i = 0; i < namedPatterns().size(); i++) {
+                reply << (i ? ", " : "") << "\"" << namedPatterns()[i] << "\"";
+            }
+            reply << "]}";
+            return reply.str();
+        }
+        if (cmd != "run") {
+            return "{\"error\": \"unknown cmd\"}";
+        }
+        
+        std::string pattern = spec.count("pattern") ? spec["pattern"] : "Sequential";
+        int iterations = NUM_ITERATIONS, warmup = WARMUP_ITERATIONS, core = defaultCore;
+        try {
+            if (spec.count("iterations")) iterations = std::stoi(spec["iterations"]);
+            if (spec.count("warmup")) warmup = std::stoi(spec["warmup"]);
+            if (spec.count("core")) core = std::stoi(spec["core"]);
+            if (spec.count("seed")) rng.seed(static_cast<uint32_t>(std::stoul(spec["seed"])));
+        } catch (const std::exception&) {
+            return "{\"error\": \"invalid numeric field\"}";
+        }
+        if (iterations < 1 || warmup < 0) {
+            return "{\"error\": \"iterations must be >= 1 and warmup >= 0\"}";
+        }
+        if (!generateNamedIndices(pattern)) {
+            return "{\"error\": \"unknown pattern\"}";
+        }
+        
+        bool pinned = core >= 0 && pin_current_thread(core);
+        std::vector<double> times = timeCurrentIndices(iterations, warmup);
+        if (core != defaultCore && defaultCore >= 0) pin_current_thread(defaultCore);
+        
+        double median_time = times[iterations / 2];
+        reply << std::fixed << std::setprecision(4)
+              << "{\"pattern\": \"" << pattern << "\""
+              << ", \"median_ms\": " << median_time
+              << ", \"min_ms\": " << times.front()
+              << ", \"max_ms\": " << times.back()
+              << ", \"ns_per_access\": " << median_time * 1e6 / indices.size()
+              << ", \"iterations\": " << iterations
+              << ", \"core\": " << core
+              << ", \"pinned\": " << (pinned ? "true" : "false") << "}";
+        return reply.str();
+    }
+    
+#ifndef _WIN32
+    // Long-running daemon: buffers stay allocated and resident, specs arrive as
+    // one JSON object per line over a Unix domain socket and run serially.
+    int runServer(const std::string& socketPath, int core) {
+        // Keep the pre-faulted buffers resident; best effort, needs RLIMIT_MEMLOCK
+        bool locked = mlock(arr.data(), arr.size() * sizeof(DataStruct)) == 0
+                   && mlock(indices.data(), indices.size() * sizeof(size_t)) == 0;
+        if (core >= 0 && !pin_current_thread(core)) {
+            std::cerr << "Warning: could not pin server to core " << core << std::endl;
+        }
+        signal(SIGPIPE, SIG_IGN);
+        
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Socket path too long: " << socketPath << std::endl;
+            return 1;
+        }
+        std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        
+        // Only a stale socket left by a server that exited is replaced: any
+        // other file, or a socket a live server still accepts on, is kept
+        struct stat existing;
+        if (lstat(socketPath.c_str(), &existing) == 0) {
+            if (!S_ISSOCK(existing.st_mode)) {
+                std::cerr << socketPath << " exists and is not a socket; not replacing it" << std::endl;
+                return 1;
+            }
+            int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+            if (probe >= 0) close(probe);
+            if (live) {
+                std::cerr << "Another server is listening on " << socketPath << std::endl;
+                return 1;
+            }
+            unlink(socketPath.c_str());
+        }
+        
+        // Owner-only socket: whoever can connect drives a pinned, mlocked process
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        mode_t previousMask = umask(0077);
+        bool bound = listener >= 0 && bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        umask(previousMask);
+        if (!bound || chmod(socketPath.c_str(), 0600) != 0 || listen(listener, 8) != 0) {
+            std::cerr << "Failed to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+            if (listener >= 0) close(listener);
+            return 1;
+        }
+        
+        std::cout << "Memory benchmark server listening on " << socketPath
+                  << " (core " << core << ", buffers " << (locked ? "locked" : "not locked")
+                  << ")" << std::endl;
+        
+        bool running = true;
+        while (running) {
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            
+            std::string pending;
+            char buffer[4096];
+            ssize_t n;
+            while (running && (n = read(client, buffer, sizeof(buffer))) > 0) {
+                pending.append(buffer, static_cast<size_t>(n));
+                size_t newline;
+                while (running && (newline = pending.find('\n')) != std::string::npos) {
+                    std::string reply = handleRequest(pending.substr(0, newline), core, running) + "\n";
+                    pending.erase(0, newline + 1);
+                    for (size_t sent = 0; sent < reply.size(); ) {
+                        ssize_t w = write(client, reply.data() + sent, reply.size() - sent);
+                        if (w <= 0) break;
+                        sent += static_cast<size_t>(w);
+                    }
+                }
+            }
+            close(client);
+        }
+        
+        close(listener);
+        unlink(socketPath.c_str());
+        return 0;
+    }
+#endif
+};
+
+// Mode list, printed for an unknown mode or a malformed option
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [mode] [options]\n"
+              << "  server        [--socket PATH] [--core N]\n"
+              << "  interference  [--victim-core N] [--aggressor-core M | --placement core|smt]\n"
+              << "  resctrl       [--core N]\n"
+              << "  oblivious     [--profile PATH]\n"
+              << "  sort          [--elements N] [--threads N]\n"
+              << "  filter        [--max-mib N]\n"
+              << "  heap          [--max-elements N]\n"
+              << "  btree\n"
+              << "  cache         [--threads N] [--zipf S]\n"
+              << "  scan\n"
+              << "  gather        [--max-mib N] [--profile PATH]\n"
+              << "  calibrate     [--profile PATH] [--max-mib N] | --verify [--profile PATH] [--tolerance F]\n"
+              << "  placement\n"
+              << "  alias\n"
+              << "  branch        [--taken PERCENT,...]\n"
+              << "  compute       [--max-rounds N]\n"
+              << "  indirection   [--levels PATTERN,... (up to 4)]\n"
+              << "  varlen        [--lengths DIST] [--max-bytes N] [--prefix-bytes K]\n"
+              << "  reuse         [--distance fixed:D|uniform:MIN:MAX|histogram:PATH]\n"
+              << "  mrc           [--rate R] [--accesses N]\n"
+              << "  synth         [--trace PATH] [--length N]\n"
+              << "  classify\n"
+              << "  latency       [--period N]\n"
+              << "  topdown       [--cpu skylake|icelake|goldencove|zen4|zen5]\n"
+              << "  dram" << std::endl;
+}
+
+// Runs the mode named by argv[1]; numeric options are parsed with std::sto*,
+// which throw on malformed input
+int run_mode(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    
+    if (mode == "server") {
+#ifdef _WIN32
+        std::cerr << "Server mode requires Unix domain sockets (Linux/macOS)" << std::endl;
+        return 1;
+#else
+        std::string socketPath = arg_value(argc, argv, "--socket", "/tmp/memory_benchmark.sock");
+        int core = std::stoi(arg_value(argc, argv, "--core", "0"));
+        MemoryBenchmark benchmark;
+        return benchmark.runServer(socketPath, core);
+#endif
+    }
+    
+    if (mode == "interference") {
+        int victimCore = std::stoi(arg_value(argc, argv, "--victim-core", "0"));
+        int sibling = smt_sibling(victimCore);
+        bool useSmt = arg_value(argc, argv, "--placement", "core") == "smt" && sibling >= 0;
+        if (arg_value(argc, argv, "--placement", "core") == "smt" && sibling < 0) {
+            std::cerr << "No SMT sibling found for core " << victimCore << "; using another core" << std::endl;
+        }
+        // Default to a different physical core: victimCore + 1 is often the victim's SMT sibling
+        int otherCore = other_physical_core(victimCore);
+        int fallbackCore = otherCore >= 0 ? otherCore : victimCore;
+        int aggressorCore = std::stoi(arg_value(argc, argv, "--aggressor-core",
+                                                std::to_string(useSmt ? sibling : fallbackCore)));
+        MemoryBenchmark benchmark;
+        benchmark.runInterference(victimCore, aggressorCore);
+        return 0;
+    }
+    
+    if (mode == "resctrl") {
+#ifdef __linux__
+        MemoryBenchmark benchmark;
+        return benchmark.runResctrlSweep(std::stoi(arg_value(argc, argv, "--core", "0")));
+#else
+        std::cout << "resctrl is Linux-only; skipping" << std::endl;
+        return 0;
+#endif
+    }
+    
+    // Modes that can start from a calibrated profile instead of their built-in tuning
+    MemoryProfile profile;
+    std::string profilePath = arg_value(argc, argv, "--profile", "");
+    bool haveProfile = !profilePath.empty() && (mode == "oblivious" || mode == "gather")
+                       && load_memory_profile_for_mode(profilePath, profile);
+    
+    if (mode == "oblivious") {
+        MemoryBenchmark benchmark;
+        benchmark.runObliviousSuite(haveProfile ? &profile : nullptr);
+        return 0;
+    }
+    
+    if (mode == "sort") {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::stoul(arg_value(argc, argv, "--threads", std::to_string(threads))));
+        size_t elements = std::stoul(arg_value(argc, argv, "--elements", "4194304"));
+        MemoryBenchmark benchmark;
+        benchmark.runSortSuite(elements, threads);
+        return 0;
+    }
+    
+    if (mode == "filter") {
+        // Default to four times the LLC, at least 64 MiB and at most 1 GiB
+        size_t llcMib = detect_cache_topology().l3 / (1024 * 1024);
+        size_t defaultMib = std::min<size_t>(1024, std::max<size_t>(64, 4 * llcMib));
+        size_t maxMib = std::stoul(arg_value(argc, argv, "--max-mib", std::to_string(defaultMib)));
+        MemoryBenchmark benchmark;
+        benchmark.runFilterSuite(maxMib * 1024 * 1024);
+        return 0;
+    }
+    
+    if (mode == "heap") {
+        size_t maxElements = std::stoul(arg_value(argc, argv, "--max-elements", "4194304"));
+        MemoryBenchmark benchmark;
+        benchmark.runHeapSuite(maxElements);
+        return 0;
+    }
+    
+    if (mode == "btree") {
+        MemoryBenchmark benchmark;
+        benchmark.runBTreeSuite();
+        return 0;
+    }
+    
+    if (mode == "cache") {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::stoul(arg_value(argc, argv, "--threads", std::to_string(threads))));
+        double zipfS = std::stod(arg_value(argc, argv, "--zipf", "0.99"));
+        MemoryBenchmark benchmark;
+        benchmark.runCacheSuite(threads, zipfS);
+        return 0;
+    }
+    
+    if (mode == "scan") {
+        MemoryBenchmark benchmark;
+        benchmark.runScanSuite();
+        return 0;
+    }
+    
+    if (mode == "gather") {
+        // Same default range as the filter mode: four times the LLC, 64 MiB to 1 GiB
+        size_t llcMib = detect_cache_topology().l3 / (1024 * 1024);
+        size_t defaultMib = std::min<size_t>(1024, std::max<size_t>(64, 4 * llcMib));
+        size_t maxMib = std::stoul(arg_value(argc, argv, "--max-mib", std::to_string(defaultMib)));
+        MemoryBenchmark benchmark;
+        benchmark.runGatherSuite(maxMib * 1024 * 1024, haveProfile ? &profile : nullptr);
+        return 0;
+    }
+    
+    if (mode == "calibrate") {
+        std::string path = arg_value(argc, argv, "--profile", "memory_profile.json");
+        bool verify = false;
+        for (int i = 2; i < argc; i++) verify |= std::string(argv[i]) == "--verify";
+        MemoryBenchmark benchmark;
+        if (verify) return benchmark.verifyProfile(path, std::stod(arg_value(argc, argv, "--tolerance", "0.2")));
+        size_t llcMib = detect_cache_topology().l3 / (1024 * 1024);
+        size_t defaultMib = std::min<size_t>(1024, std::max<size_t>(64, 4 * llcMib));
+        size_t maxMib = std::stoul(arg_value(argc, argv, "--max-mib", std::to_string(defaultMib)));
+        return benchmark.runCalibration(path, maxMib * 1024 * 1024);
+    }
+    
+    if (mode == "placement") {
+        MemoryBenchmark benchmark;
+        benchmark.runPlacementSuite();
+        return 0;
+    }
+    
+    if (mode == "alias") {
+        MemoryBenchmark benchmark;
+        benchmark.runAliasSuite();
+        return 0;
+    }
+    
+    if (mode == "branch") {
+        // Percent of accesses taking the branch, e.g. --taken 0,50,100
+        std::vector<double> takenPercents;
+        std::stringstream list(arg_value(argc, argv, "--taken", "0,1,5,10,25,50,75,90,95,99,100"));
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            takenPercents.push_back(std::min(100.0, std::max(0.0, std::stod(item))));
+        }
+        if (takenPercents.empty()) takenPercents.push_back(50.0);
+        MemoryBenchmark benchmark;
+        benchmark.runBranchSuite(takenPercents);
+        return 0;
+    }
+    
+    if (mode == "compute") {
+        MemoryBenchmark benchmark;
+        benchmark.runComputeSuite(std::stoul(arg_value(argc, argv, "--max-rounds", "128")));
+        return 0;
+    }
+    
+    if (mode == "indirection") {
+        // Level patterns from the first level down, e.g. --levels Sequential,Random,Clustered
+        std::vector<std::vector<std::string>> chains;
+        std::string levels = arg_value(argc, argv, "--levels", "");
+        if (levels.empty()) {
+            for (const std::string first : {"Sequential", "Random", "Clustered"}) {
+                const std::string rest = first == "Clustered" ? "Clustered" : "Random";
+                chains.push_back({first, rest, rest, rest});
+            }
+            chains.push_back({"Sequential", "Sequential", "Sequential", "Sequential"});
+        } else {
+            chains.emplace_back();
+            std::stringstream list(levels);
+            std::string item;
+            while (std::getline(list, item, ',') && chains.back().size() < 4) chains.back().push_back(item);
+        }
+        MemoryBenchmark benchmark;
+        for (const auto& chain : chains) {
+            for (const auto& level : chain) {
+                if (!benchmark.generateNamedIndices(level)) {
+                    std::cerr << "Unknown level pattern: " << level << std::endl;
+                    return 1;
+                }
+            }
+        }
+        benchmark.runIndirectionSuite(chains);
+        return 0;
+    }
+    
+    if (mode == "varlen") {
+        LengthDistribution lengths;
+        std::string spec = arg_value(argc, argv, "--lengths", "lognormal:24:1.0");
+        if (!lengths.parse(spec)) {
+            std::cerr << "Bad --lengths " << spec << " (fixed:N, uniform:MIN:MAX or lognormal:MEDIAN:SIGMA)" << std::endl;
+            return 1;
+        }
+        lengths.maxLength = std::stoul(arg_value(argc, argv, "--max-bytes", "512"));
+        MemoryBenchmark benchmark;
+        benchmark.runVarlenSuite(lengths, std::stoul(arg_value(argc, argv, "--prefix-bytes", "16")));
+        return 0;
+    }
+    
+    if (mode == "reuse") {
+        std::string spec = arg_value(argc, argv, "--distance", "");
+        ReuseDistribution dist;
+        std::string error;
+        if (!spec.empty() && !dist.parse(spec, error)) {
+            std::cerr << "Bad --distance: " << error << std::endl;
+            return 1;
+        }
+        MemoryBenchmark benchmark;
+        benchmark.runReuseSuite(spec.empty() ? nullptr : &dist);
+        return 0;
+    }
+    
+    if (mode == "mrc") {
+        double rate = std::stod(arg_value(argc, argv, "--rate", "0.01"));
+        size_t accesses = std::stoull(arg_value(argc, argv, "--accesses", "16777216"));
+        MemoryBenchmark benchmark;
+        benchmark.runMrcSuite(rate, accesses);
+        return 0;
+    }
+    
+    if (mode == "synth") {
+        MemoryBenchmark benchmark;
+        return benchmark.runStrideModelSuite(arg_value(argc, argv, "--trace", ""),
+                                             std::stoull(arg_value(argc, argv, "--length", "0")));
+    }
+    
+    if (mode == "classify") {
+        MemoryBenchmark benchmark;
+        benchmark.runClassifierSuite();
+        return 0;
+    }
+    
+    if (mode == "latency") {
+        MemoryBenchmark benchmark;
+        benchmark.runLatencySuite(std::stoull(arg_value(argc, argv, "--period", "1009")));
+        return 0;
+    }
+    
+    if (mode == "topdown") {
+        // --cpu picks an event table when detection fails (e.g. a newer model number)
+        std::string cpu = arg_value(argc, argv, "--cpu", "");
+        const TopdownTable* table = cpu.empty() ? topdown_table_for_cpu() : topdown_table(cpu);
+        if (!cpu.empty() && !table) {
+            std::cerr << "Unknown --cpu " << cpu << " (";
+            for (const auto& known : topdown_tables()) std::cerr << " " << known.name;
+            std::cerr << " )" << std::endl;
+            return 1;
+        }
+        MemoryBenchmark benchmark;
+        benchmark.runTopdownSuite(table);
+        return 0;
+    }
+    
+    if (mode == "dram") {
+        MemoryBenchmark benchmark;
+        benchmark.runDramTrafficSuite();
+        return 0;
+    }
+    
+    if (!mode.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    MemoryBenchmark benchmark;
+    benchmark.runBenchmarks();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        return run_mode(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Invalid numeric argument (" << e.what() << ")" << std::endl;
+    } catch (const std::out_of_range& e) {
+        std::cerr << "Numeric argument out of range (" << e.what() << ")" << std::endl;
+    }
+    print_usage(argv[0]);
+    return 1;
 }
@@ -0,0 +1,287 @@
+// memory_profile.h
+// Per-machine tuning profile written by the `calibrate` mode and loaded by
+// other modes (or services) at startup instead of re-measuring. It is stored
+// as one flat JSON object so parse_flat_json, or any JSON library, can read
+// it; the machine identity fields decide whether a profile applies to a host,
+// and the reference measurements let a quick re-run detect a stale profile.
+// load_memory_profile() is the startup entry point: it reads the file and
+// rejects profiles from another VERSION or another machine.
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/utsname.h>
+#endif
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+#include "cache_topology.h"
+#include "gather.h"
+
+struct MachineIdentity {
+    std::string cpuModel, kernel;
+    unsigned logicalCpus = 0;
+    size_t l1d = 0, l2 = 0, l3 = 0, lineSize = 0;
+};
+
+// Outcome of loading a profile: a profile written with another VERSION or on
+// another machine is readable JSON but stale, anything else that fails is unusable
+enum class ProfileStatus { Ok, Unusable, OutdatedVersion, OtherMachine };
+
+struct MemoryProfile {
+    static constexpr int VERSION = 1; // Bump when fields change meaning
+
+    int version = VERSION;
+    MachineIdentity machine;
+    int64_t created = 0; // Unix time
+    GatherTuning gather;
+    size_t transposeTile = 0, matmulTile = 0;
+    unsigned bandwidthThreads = 1; // Fewest threads reaching 95% of peak triad bandwidth
+    // Reference measurements repeated by verification
+    double sequentialNs = 0.0, randomNs = 0.0, triadGBps = 0.0;
+
+    std::string toJson() const {
+        std::ostringstream json;
+        json.precision(6);
+        json << "{\n"
+             << "  \"version\": " << version << ",\n"
+             << "  \"cpu_model\": \"" << escape(machine.cpuModel) << "\",\n"
+             << "  \"logical_cpus\": " << machine.logicalCpus << ",\n"
+             << "  \"l1d_bytes\": " << machine.l1d << ",\n"
+             << "  \"l2_bytes\": " << machine.l2 << ",\n"
+             << "  \"l3_bytes\": " << machine.l3 << ",\n"
+             << "  \"line_bytes\": " << machine.lineSize << ",\n"
+             << "  \"kernel\": \"" << escape(machine.kernel) << "\",\n"
+             << "  \"created\": " << created << ",\n"
+             << "  \"prefetch_distance\": " << gather.prefetchDistance << ",\n"
+             << "  \"gather_batch_size\": " << gather.batchSize << ",\n"
+             << "  \"gather_partition_bytes\": " << gather.partitionBytes << ",\n"
+             << "  \"gather_strategy_by_size\": \"" << encodeStrategies() << "\",\n"
+             << "  \"transpose_tile\": " << transposeTile << ",\n"
+             << "  \"matmul_tile\": " << matmulTile << ",\n"
+             << "  \"bandwidth_threads\": " << bandwidthThreads << ",\n"
+             << "  \"ref_sequential_ns\": " << sequentialNs << ",\n"
+             << "  \"ref_random_ns\": " << randomNs << ",\n"
+             << "  \"ref_triad_gbps\": " << triadGBps << "\n"
+             << "}\n";
+        return json.str();
+    }
+
+    // Fills the profile from parsed JSON fields; sets `error` unless Ok
+    ProfileStatus fromFields(const std::map<std::string, std::string>& fields, std::string& error) {
+        try {
+            auto get = [&](const char* name) -> const std::string& {
+                auto it = fields.find(name);
+                if (it == fields.end()) throw std::string("missing field ") + name;
+                return it->second;
+            };
+            version = std::stoi(get("version"));
+            if (version != VERSION) {
+                error = "profile version " + std::to_string(version) + ", expected " + std::to_string(VERSION);
+                return ProfileStatus::OutdatedVersion;
+            }
+            machine.cpuModel = get("cpu_model");
+            machine.logicalCpus = static_cast<unsigned>(std::stoul(get("logical_cpus")));
+            machine.l1d = std::stoull(get("l1d_bytes"));
+            machine.l2 = std::stoull(get("l2_bytes"));
+            machine.l3 = std::stoull(get("l3_bytes"));
+            machine.lineSize = std::stoull(get("line_bytes"));
+            machine.kernel = get("kernel");
+            created = std::stoll(get("created"));
+            gather.prefetchDistance = std::stoull(get("prefetch_distance"));
+            gather.batchSize = std::stoull(get("gather_batch_size"));
+            gather.partitionBytes = std::stoull(get("gather_partition_bytes"));
+            if (!decodeStrategies(get("gather_strategy_by_size"))) throw std::string("bad gather_strategy_by_size");
+            transposeTile = std::stoull(get("transpose_tile"));
+            matmulTile = std::stoull(get("matmul_tile"));
+            bandwidthThreads = static_cast<unsigned>(std::stoul(get("bandwidth_threads")));
+            sequentialNs = std::stod(get("ref_sequential_ns"));
+            randomNs = std::stod(get("ref_random_ns"));
+            triadGBps = std::stod(get("ref_triad_gbps"));
+        } catch (const std::string& message) {
+            error = message;
+            return ProfileStatus::Unusable;
+        } catch (const std::exception&) {
+            error = "malformed numeric field";
+            return ProfileStatus::Unusable;
+        }
+        return ProfileStatus::Ok;
+    }
+
+    // Identity fields that differ from `current`; empty when the profile applies to this host
+    std::vector<std::string> identityMismatches(const MachineIdentity& current) const {
+        std::vector<std::string> differ;
+        if (machine.cpuModel != current.cpuModel) differ.push_back("cpu_model");
+        if (machine.logicalCpus != current.logicalCpus) differ.push_back("logical_cpus");
+        if (machine.l1d != current.l1d || machine.l2 != current.l2 || machine.l3 != current.l3
+            || machine.lineSize != current.lineSize) differ.push_back("cache topology");
+        if (machine.kernel != current.kernel) differ.push_back("kernel");
+        return differ;
+    }
+
+private:
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    // "bytes:strategy,bytes:strategy,..." in ascending size order
+    std::string encodeStrategies() const {
+        std::string text;
+        for (const auto& entry : gather.bySize) {
+            if (!text.empty()) text += ',';
+            text += std::to_string(entry.first) + ':' + gather_strategy_name(entry.second);
+        }
+        return text;
+    }
+
+    bool decodeStrategies(const std::string& text) {
+        gather.bySize.clear();
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t colon = item.find(':');
+            GatherStrategy strategy;
+            if (colon == std::string::npos || !parse_gather_strategy(item.substr(colon + 1), strategy)) return false;
+            gather.bySize.push_back({std::stoull(item.substr(0, colon)), strategy});
+        }
+        return true;
+    }
+};
+
+// Minimal parser for flat JSON objects such as {"pattern": "Random", "core": 2}.
+// Values are kept as strings; nested objects and arrays are not supported.
+inline bool parse_flat_json(const std::string& text, std::map<std::string, std::string>& out) {
+    size_t pos = 0;
+    auto skip_ws = [&]() {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    };
+    auto read_string = [&](std::string& s) {
+        if (pos >= text.size() || text[pos] != '"') return false;
+        for (pos++; pos < text.size() && text[pos] != '"'; pos++) {
+            if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+            s += text[pos];
+        }
+        return pos++ < text.size();
+    };
+    
+    skip_ws();
+    if (pos >= text.size() || text[pos++] != '{') return false;
+    skip_ws();
+    if (pos < text.size() && text[pos] == '}') return true;
+    
+    while (pos < text.size()) {
+        std::string key, value;
+        skip_ws();
+        if (!read_string(key)) return false;
+        skip_ws();
+        if (pos >= text.size() || text[pos++] != ':') return false;
+        skip_ws();
+        if (pos < text.size() && text[pos] == '"') {
+            if (!read_string(value)) return false;
+        } else {
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}'
+                   && !isspace(static_cast<unsigned char>(text[pos]))) {
+                value += text[pos++];
+            }
+            if (value.empty()) return false;
+        }
+        out[key] = value;
+        skip_ws();
+        if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+        return pos < text.size() && text[pos] == '}';
+    }
+    return false;
+}
+
+// CPU model, cache topology and OS kernel: the key a memory profile is valid for
+inline MachineIdentity detect_machine_identity() {
+    CacheTopology topo = detect_cache_topology();
+    MachineIdentity id;
+    id.cpuModel = "unknown";
+    id.kernel = "unknown";
+    id.logicalCpus = std::thread::hardware_concurrency();
+    id.l1d = topo.l1d;
+    id.l2 = topo.l2;
+    id.l3 = topo.l3;
+    id.lineSize = topo.lineSize;
+#ifdef _WIN32
+    char name[256];
+    DWORD size = sizeof(name);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0",
+                     "ProcessorNameString", RRF_RT_REG_SZ, nullptr, name, &size) == ERROR_SUCCESS) {
+        id.cpuModel = name;
+    }
+    id.kernel = "Windows";
+#else
+    utsname uts;
+    if (uname(&uts) == 0) id.kernel = std::string(uts.sysname) + " " + uts.release;
+#endif
+#ifdef __linux__
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        // "model name" on x86, "Processor" or "CPU part" on some Arm kernels
+        if (line.compare(0, 10, "model name") != 0 && line.compare(0, 9, "Processor") != 0) continue;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos && colon + 2 <= line.size()) {
+            id.cpuModel = line.substr(colon + 2);
+            break;
+        }
+    }
+#elif defined(__APPLE__)
+    char brand[256];
+    size_t length = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &length, nullptr, 0) == 0) id.cpuModel = brand;
+#endif
+    return id;
+}
+
+// Reads a profile written by the calibrate mode; sets `error` unless Ok
+inline ProfileStatus read_memory_profile(const std::string& path, MemoryProfile& profile, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return ProfileStatus::Unusable;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::map<std::string, std::string> fields;
+    if (!parse_flat_json(text.str(), fields)) {
+        error = "malformed JSON in " + path;
+        return ProfileStatus::Unusable;
+    }
+    return profile.fromFields(fields, error);
+}
+
+// Reads a profile and checks it applies to this machine; sets `error` unless Ok
+inline ProfileStatus load_memory_profile(const std::string& path, MemoryProfile& profile, std::string& error) {
+    ProfileStatus status = read_memory_profile(path, profile, error);
+    if (status != ProfileStatus::Ok) return status;
+    std::vector<std::string> differ = profile.identityMismatches(detect_machine_identity());
+    if (differ.empty()) return ProfileStatus::Ok;
+    error = "calibrated on another machine (";
+    for (size_t i = 0; i < differ.size(); i++) error += (i ? ", " : "") + differ[i];
+    error += differ.size() > 1 ? " differ)" : " differs)";
+    return ProfileStatus::OtherMachine;
+}
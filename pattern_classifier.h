@@ -0,0 +1,120 @@
+// pattern_classifier.h
+// Streaming classifier that labels each window of an index stream with the
+// suite pattern it resembles, plus a confidence in [0, 1]. Every feature is a
+// fraction of positions satisfying a difference test, computed with
+// branch-free loops over the window that the compiler vectorizes:
+//   same1   - x[t] - x[t-1] repeats the previous difference (constant stride)
+//   sameK   - x[t] - x[t-k] repeats, k = 2..8 (k interleaved constant streams)
+//   flip2   - x[t] - x[t-2] negates the previous one (two streams moving
+//             in opposite directions: Bouncing)
+//   near    - |x[t] - x[t-1]| <= nearDistance
+// Indices are element numbers; nearDistance sets what counts as a short hop.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class AccessPattern { Sequential, Backward, Strided, Interleaved, Bouncing, Clustered, Random };
+
+inline const char* access_pattern_name(AccessPattern pattern) {
+    switch (pattern) {
+        case AccessPattern::Sequential: return "sequential";
+        case AccessPattern::Backward: return "backward";
+        case AccessPattern::Strided: return "strided";
+        case AccessPattern::Interleaved: return "interleaved";
+        case AccessPattern::Bouncing: return "bouncing";
+        case AccessPattern::Clustered: return "clustered";
+        case AccessPattern::Random: return "random";
+    }
+    return "random";
+}
+
+struct PatternLabel {
+    AccessPattern pattern;
+    unsigned streams;  // Interleaved stream count k, otherwise 1
+    double confidence; // Fraction of the window supporting the label
+};
+
+class PatternClassifier {
+public:
+    static constexpr size_t MAX_STREAMS = 8;
+    static constexpr double THRESHOLD = 0.9; // Fraction a regular pattern must reach
+
+    explicit PatternClassifier(size_t window = 4096, int64_t nearDistance = 64)
+        : window_(window < 2 * MAX_STREAMS ? 2 * MAX_STREAMS : window), near_(nearDistance) {
+        buffer_.reserve(window_);
+    }
+
+    // Labels one window of n >= 2 * MAX_STREAMS unsigned indices
+    template<typename Index>
+    PatternLabel classify(const Index* x, size_t n) const {
+        const size_t first = MAX_STREAMS + 1; // Every test needs x[t-1-k] for k <= MAX_STREAMS
+        const double positions = static_cast<double>(n - first);
+
+        size_t same1 = 0, near = 0, up = 0;
+        for (size_t t = first; t < n; t++) {
+            int64_t d = static_cast<int64_t>(uint64_t(x[t]) - x[t - 1]);
+            int64_t before = static_cast<int64_t>(uint64_t(x[t - 1]) - x[t - 2]);
+            same1 += d == before;
+            near += (d <= near_) & (d >= -near_);
+            up += d > 0;
+        }
+        double same1Fraction = same1 / positions, nearFraction = near / positions;
+
+        if (same1Fraction >= THRESHOLD) {
+            if (nearFraction >= 0.99) {
+                return {up * 2 >= n - first ? AccessPattern::Sequential : AccessPattern::Backward, 1, same1Fraction};
+            }
+            return {AccessPattern::Strided, 1, same1Fraction};
+        }
+
+        for (size_t k = 2; k <= MAX_STREAMS; k++) {
+            size_t same = 0;
+            for (size_t t = first; t < n; t++) same += uint64_t(x[t]) - x[t - k] == uint64_t(x[t - 1]) - x[t - 1 - k];
+            if (same / positions >= THRESHOLD) {
+                return {AccessPattern::Interleaved, static_cast<unsigned>(k), same / positions};
+            }
+        }
+
+        size_t flip2 = 0;
+        for (size_t t = first; t < n; t++) {
+            uint64_t d = uint64_t(x[t]) - x[t - 2];
+            flip2 += (d == 0 - (uint64_t(x[t - 1]) - x[t - 3])) & (d != 0);
+        }
+        if (flip2 / positions >= THRESHOLD) return {AccessPattern::Bouncing, 2, flip2 / positions};
+
+        if (nearFraction >= 0.5) return {AccessPattern::Clustered, 1, nearFraction};
+        return {AccessPattern::Random, 1, 1.0 - nearFraction};
+    }
+
+    // Streaming use: calls onLabel(label) for every completed window, in
+    // place when a whole window arrives at once; a partial window waits in
+    // the buffer for the next push
+    template<typename Index, typename OnLabel>
+    void push(const Index* x, size_t n, OnLabel onLabel) {
+        size_t i = 0;
+        while (i < n) {
+            if (buffer_.empty() && n - i >= window_) {
+                onLabel(classify(x + i, window_));
+                i += window_;
+                continue;
+            }
+            size_t take = std::min(window_ - buffer_.size(), n - i);
+            buffer_.insert(buffer_.end(), x + i, x + i + take);
+            i += take;
+            if (buffer_.size() == window_) {
+                onLabel(classify(buffer_.data(), buffer_.size()));
+                buffer_.clear();
+            }
+        }
+    }
+
+    size_t window() const { return window_; }
+
+private:
+    size_t window_;
+    int64_t near_;
+    std::vector<uint64_t> buffer_;
+};
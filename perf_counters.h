@@ -0,0 +1,267 @@
+// perf_counters.h
+// Thin wrapper over Linux perf_event_open for counting hardware events around
+// a measured region. Each event is opened on its own and scaled by
+// time_enabled / time_running, so multiplexed events still give estimates.
+// On other platforms, or when the PMU is not exposed (many VMs), add() fails
+// and callers report the counter as unavailable. perf_sysfs_event() encodes
+// named events that the kernel publishes per PMU (mem-loads, uncore events);
+// PerfEventGroup reads several events as one unit for exact ratios.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Encoding of one event in /sys/bus/event_source/devices/<pmu>
+struct PerfEventSpec {
+    uint32_t type = 0;
+    uint64_t config = 0, config1 = 0, config2 = 0;
+    double scale = 1.0; // events/<name>.scale, e.g. bytes per CAS for uncore IMC
+    std::string unit;   // events/<name>.unit
+};
+
+// Looks up `event` of `pmu` and packs its terms ("event=0xcd,umask=0x1,ldlat=3")
+// into config words using the PMU's format/ bit ranges ("config1:0-15");
+// `event` may also be such a term list. False when the PMU, event or a term's
+// format is missing
+inline bool perf_sysfs_event(const std::string& pmu, const std::string& event, PerfEventSpec& spec) {
+    const std::string root = "/sys/bus/event_source/devices/" + pmu;
+    auto readLine = [](const std::string& path, std::string& line) {
+        std::ifstream file(path);
+        return static_cast<bool>(std::getline(file, line));
+    };
+    std::string line;
+    if (!readLine(root + "/type", line)) return false;
+    spec = PerfEventSpec();
+    spec.type = static_cast<uint32_t>(std::stoul(line));
+
+    std::string terms = event;
+    if (event.find('=') == std::string::npos) {
+        if (!readLine(root + "/events/" + event, terms)) return false;
+        if (readLine(root + "/events/" + event + ".scale", line)) spec.scale = std::stod(line);
+        readLine(root + "/events/" + event + ".unit", spec.unit);
+    }
+
+    std::stringstream list(terms);
+    std::string term;
+    while (std::getline(list, term, ',')) {
+        size_t eq = term.find('=');
+        std::string name = term.substr(0, eq);
+        name.erase(0, name.find_first_not_of(" \n"));
+        if (name.empty()) continue;
+        uint64_t value = eq == std::string::npos ? 1 : std::stoull(term.substr(eq + 1), nullptr, 0);
+
+        // Format "config:0-7,32-35": value bits fill the ranges from the low end
+        std::string format;
+        if (!readLine(root + "/format/" + name, format)) return false;
+        size_t colon = format.find(':');
+        if (colon == std::string::npos) return false;
+        std::string field = format.substr(0, colon);
+        uint64_t* word = field == "config" ? &spec.config : field == "config1" ? &spec.config1
+                       : field == "config2" ? &spec.config2 : nullptr;
+        if (!word) return false;
+        std::stringstream ranges(format.substr(colon + 1));
+        std::string range;
+        while (std::getline(ranges, range, ',')) {
+            size_t dash = range.find('-');
+            unsigned lo = std::stoul(range.substr(0, dash));
+            unsigned hi = dash == std::string::npos ? lo : std::stoul(range.substr(dash + 1));
+            for (unsigned bit = lo; bit <= hi && bit < 64; bit++, value >>= 1) {
+                *word |= (value & 1) << bit;
+            }
+        }
+    }
+    return true;
+}
+
+class PerfCounters {
+public:
+    // Common events; type/config follow perf_event_attr
+    static constexpr uint32_t TYPE_HARDWARE = 0; // PERF_TYPE_HARDWARE
+    static constexpr uint32_t TYPE_HW_CACHE = 3; // PERF_TYPE_HW_CACHE
+    static constexpr uint32_t TYPE_RAW = 4;      // PERF_TYPE_RAW
+    static constexpr uint64_t HW_CPU_CYCLES = 0;
+    static constexpr uint64_t HW_INSTRUCTIONS = 1;
+    static constexpr uint64_t HW_CACHE_REFERENCES = 2;
+    static constexpr uint64_t HW_CACHE_MISSES = 3; // Last-level cache misses on most PMUs
+    static constexpr uint64_t HW_BRANCH_MISSES = 5;
+    static constexpr uint64_t HW_CACHE_L1D_READ_MISS = 0x10000; // L1D | OP_READ << 8 | RESULT_MISS << 16
+
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const auto& c : counters_) close(c.fd);
+#endif
+    }
+
+    // Opens one user-space event for the calling thread; with `inherit`, threads
+    // it creates afterwards are counted too, once they exit. False if unsupported
+    bool add(const std::string& name, uint32_t type, uint64_t config, bool inherit = false) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0) return false;
+        counters_.push_back({name, fd});
+        return true;
+#else
+        (void)name; (void)type; (void)config; (void)inherit;
+        return false;
+#endif
+    }
+
+    bool empty() const { return counters_.empty(); }
+
+    void start() {
+#ifdef __linux__
+        for (const auto& c : counters_) {
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (const auto& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    // Scaled count since the last start(), or NaN if the event is unknown or never ran
+    double value(const std::string& name) const {
+#ifdef __linux__
+        for (const auto& c : counters_) {
+            if (c.name != name) continue;
+            uint64_t data[3] = {0, 0, 0}; // value, time_enabled, time_running
+            if (read(c.fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+                return std::nan("");
+            }
+            return static_cast<double>(data[0]) * data[1] / data[2];
+        }
+#else
+        (void)name;
+#endif
+        return std::nan("");
+    }
+
+private:
+    struct Counter {
+        std::string name;
+        int fd;
+    };
+    std::vector<Counter> counters_;
+};
+
+// Events read as one group: the kernel schedules all of them or none, so when
+// the PMU multiplexes, every member covers the same time slices and ratios
+// between members stay exact. Counts are scaled to the whole enabled time and
+// coverage() reports the running / enabled share
+class PerfEventGroup {
+public:
+    PerfEventGroup() = default;
+    PerfEventGroup(const PerfEventGroup&) = delete;
+    PerfEventGroup& operator=(const PerfEventGroup&) = delete;
+
+    ~PerfEventGroup() { close(); }
+
+    // The first event added leads the group; false if the event cannot join it
+    bool add(const std::string& name, const PerfEventSpec& spec) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.config1 = spec.config1;
+        attr.config2 = spec.config2;
+        attr.disabled = events_.empty() ? 1 : 0; // Members follow the leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int leader = events_.empty() ? -1 : events_.front().fd;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+        if (fd < 0) return false;
+        events_.push_back({name, fd, std::nan("")});
+        return true;
+#else
+        (void)name; (void)spec;
+        return false;
+#endif
+    }
+
+    bool empty() const { return events_.empty(); }
+
+    void start() {
+#ifdef __linux__
+        if (events_.empty()) return;
+        ioctl(events_.front().fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(events_.front().fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Disables the group and latches its scaled counts
+    void stop() {
+#ifdef __linux__
+        if (events_.empty()) return;
+        ioctl(events_.front().fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        std::vector<uint64_t> data(3 + events_.size(), 0); // nr, time_enabled, time_running, values
+        ssize_t bytes = static_cast<ssize_t>(data.size() * sizeof(uint64_t));
+        bool ok = read(events_.front().fd, data.data(), bytes) == bytes && data[0] == events_.size();
+        coverage_ = ok && data[1] ? static_cast<double>(data[2]) / data[1] : 0.0;
+        for (size_t i = 0; i < events_.size(); i++) {
+            events_[i].value = ok && data[2] ? static_cast<double>(data[3 + i]) * data[1] / data[2] : std::nan("");
+        }
+#endif
+    }
+
+    // Scaled count latched by the last stop(), or NaN if the group never ran
+    double value(const std::string& name) const {
+        for (const auto& e : events_) {
+            if (e.name == name) return e.value;
+        }
+        return std::nan("");
+    }
+
+    double coverage() const { return coverage_; }
+
+    void close() {
+#ifdef __linux__
+        for (auto it = events_.rbegin(); it != events_.rend(); ++it) ::close(it->fd);
+#endif
+        events_.clear();
+        coverage_ = 0.0;
+    }
+
+private:
+    struct Event {
+        std::string name;
+        int fd;
+        double value;
+    };
+    std::vector<Event> events_;
+    double coverage_ = 0.0;
+};
@@ -0,0 +1,277 @@
+// perf_sampling.h
+// Precise load sampling through perf_event_open: every Nth qualifying load
+// records its instruction pointer, data address, latency in cycles (weight)
+// and the level of the hierarchy that served it (data source). Intel uses
+// the PEBS load-latency event mem-loads, AMD the IBS op PMU. IBS tags every
+// Nth op of any kind, so its samples include stores and non-memory ops;
+// samplesAllOps() tells the caller to keep only is_load_sample() records. Records are read straight from the mmap'ed ring buffer,
+// without the perf tool. open() fails with a reason on other platforms and on
+// CPUs, VMs or kernels without support.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct LoadSample {
+    uint64_t ip, addr, weight, dataSrc;
+};
+
+enum class DataSource { L1, LFB, L2, L3, DRAM, Remote, Other };
+
+inline const char* data_source_name(DataSource source) {
+    switch (source) {
+        case DataSource::L1: return "L1";
+        case DataSource::LFB: return "LFB";
+        case DataSource::L2: return "L2";
+        case DataSource::L3: return "L3";
+        case DataSource::DRAM: return "DRAM";
+        case DataSource::Remote: return "Remote";
+        case DataSource::Other: return "Other";
+    }
+    return "Other";
+}
+
+// True when perf_mem_data_src's mem_op field (bits 0-4) marks a load
+inline bool is_load_sample(uint64_t dataSrc) {
+    return (dataSrc & 0x1f) & 0x2; // PERF_MEM_OP_LOAD
+}
+
+// Decodes perf_mem_data_src: the level number and remote bit when the kernel
+// fills them (newer kernels, AMD IBS), otherwise the older mem_lvl bit mask,
+// whose level bits name the level that served the load only when HIT is set
+inline DataSource decode_data_source(uint64_t dataSrc) {
+    const uint64_t lvl = (dataSrc >> 5) & 0x3fff; // PERF_MEM_LVL_SHIFT
+    const uint64_t num = (dataSrc >> 33) & 0xf;   // PERF_MEM_LVLNUM_SHIFT
+    const bool remote = (dataSrc >> 37) & 1;      // PERF_MEM_REMOTE_SHIFT
+    if (num != 0 && num != 0xf) {                 // PERF_MEM_LVLNUM_NA
+        switch (num) {
+            case 0x1: return DataSource::L1;      // PERF_MEM_LVLNUM_L1
+            case 0xc: return DataSource::LFB;     // PERF_MEM_LVLNUM_LFB
+            case 0x2: return remote ? DataSource::Remote : DataSource::L2;
+            case 0x3: return remote ? DataSource::Remote : DataSource::L3;
+            case 0xb: return remote ? DataSource::Remote : DataSource::L3; // ANY_CACHE: another core's cache
+            case 0xd: case 0xe: return remote ? DataSource::Remote : DataSource::DRAM; // RAM, PMEM
+            default: return DataSource::Other;
+        }
+    }
+    if (!(lvl & 0x02)) return DataSource::Other; // PERF_MEM_LVL_HIT clear: NA or a miss
+    if (lvl & 0xf00) return DataSource::Remote; // PERF_MEM_LVL_REM_RAM1/2, REM_CCE1/2
+    if (lvl & 0x80) return DataSource::DRAM;    // PERF_MEM_LVL_LOC_RAM
+    if (lvl & 0x40) return DataSource::L3;
+    if (lvl & 0x20) return DataSource::L2;
+    if (lvl & 0x10) return DataSource::LFB;
+    if (lvl & 0x08) return DataSource::L1;
+    return DataSource::Other;
+}
+
+class LoadLatencySampler {
+public:
+    static constexpr uint32_t RECORD_LOST = 2;   // PERF_RECORD_LOST
+    static constexpr uint32_t RECORD_SAMPLE = 9; // PERF_RECORD_SAMPLE
+    static constexpr size_t RING_PAGES = 64;     // Data pages, a power of two
+
+    LoadLatencySampler() = default;
+    LoadLatencySampler(const LoadLatencySampler&) = delete;
+    LoadLatencySampler& operator=(const LoadLatencySampler&) = delete;
+    ~LoadLatencySampler() { close(); }
+
+    // Opens sampling of every `period`-th qualifying load (every op under IBS)
+    // of the calling thread; false with `error` when neither PEBS nor IBS can
+    // be opened
+    bool open(uint64_t period, std::string& error) {
+#ifdef __linux__
+        close();
+        PerfEventSpec spec;
+        for (const char* pmu : {"cpu", "cpu_core"}) { // cpu_core: P-cores of hybrid parts
+            if (!perf_sysfs_event(pmu, "mem-loads", spec)) continue;
+            // Sapphire Rapids and later only sample mem-loads in a group led by mem-loads-aux
+            PerfEventSpec aux;
+            if (perf_sysfs_event(pmu, "mem-loads-aux", aux)) {
+                perf_event_attr attr = baseAttr(aux, 0);
+                leader_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+                if (leader_ < 0) continue;
+            }
+            for (int precise = 3; precise >= 1 && fd_ < 0; precise--) {
+                perf_event_attr attr = baseAttr(spec, period);
+                attr.precise_ip = precise;
+                fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+            }
+            if (fd_ >= 0) {
+                method_ = std::string("PEBS load latency (") + pmu + "/mem-loads)";
+                break;
+            }
+            closeLeader();
+        }
+        // ibs_op has no events/ entries; cnt_ctl=1 makes the period count
+        // dispatched ops rather than cycles. Kernels without that format term
+        // still take a bare config of 0 on the PMU's dynamic type
+        std::ifstream ibsType("/sys/bus/event_source/devices/ibs_op/type");
+        uint32_t type = 0;
+        if (fd_ < 0 && ibsType >> type) {
+            if (!perf_sysfs_event("ibs_op", "cnt_ctl=1", spec)) {
+                spec = PerfEventSpec();
+                spec.type = type;
+            }
+            // IBS counts ops in units of 16 and cannot exclude the kernel on older kernels
+            perf_event_attr attr = baseAttr(spec, std::max<uint64_t>(period, 0x90) & ~uint64_t(15));
+            attr.exclude_kernel = 0;
+            attr.exclude_hv = 0;
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd_ >= 0) {
+                method_ = "AMD IBS op";
+                allOps_ = true;
+            }
+        }
+        if (fd_ < 0) {
+            error = "no PEBS mem-loads or IBS op event could be opened (VM, unsupported CPU or "
+                    "perf_event_paranoid too strict)";
+            return false;
+        }
+
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        mapBytes_ = (RING_PAGES + 1) * page;
+        void* ring = mmap(nullptr, mapBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (ring == MAP_FAILED) {
+            close();
+            error = "cannot map the sample ring buffer";
+            return false;
+        }
+        ring_ = static_cast<uint8_t*>(ring);
+        return true;
+#else
+        (void)period;
+        error = "load sampling needs Linux perf_event_open";
+        return false;
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd_ < 0) return;
+        int target = leader_ >= 0 ? leader_ : fd_;
+        ioctl(target, PERF_EVENT_IOC_ENABLE, leader_ >= 0 ? PERF_IOC_FLAG_GROUP : 0);
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        if (fd_ < 0) return;
+        int target = leader_ >= 0 ? leader_ : fd_;
+        ioctl(target, PERF_EVENT_IOC_DISABLE, leader_ >= 0 ? PERF_IOC_FLAG_GROUP : 0);
+#endif
+    }
+
+    // Appends the samples written since the last drain and frees their space;
+    // call often enough that the ring (RING_PAGES pages) does not overflow,
+    // otherwise the kernel drops records and lost() grows
+    void drain(std::vector<LoadSample>& out) {
+#ifdef __linux__
+        if (!ring_) return;
+        auto* meta = reinterpret_cast<perf_event_mmap_page*>(ring_);
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const uint64_t offset = meta->data_offset ? meta->data_offset : page;
+        const uint64_t size = meta->data_size ? meta->data_size : RING_PAGES * page;
+        uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = meta->data_tail;
+        tail = parse_ring(ring_ + offset, size, tail, head, out, lost_);
+        __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+#else
+        (void)out;
+#endif
+    }
+
+    // Parses records in [tail, head) of a ring of `size` bytes (a power of two),
+    // where positions count bytes ever written; records may wrap around the
+    // end. Returns the new tail. Samples must have been requested as
+    // IP | ADDR | WEIGHT | DATA_SRC, which the kernel writes in that order
+    static uint64_t parse_ring(const uint8_t* data, uint64_t size, uint64_t tail, uint64_t head,
+                               std::vector<LoadSample>& out, uint64_t& lost) {
+        auto copy = [&](uint64_t position, void* to, size_t bytes) {
+            uint8_t* dest = static_cast<uint8_t*>(to);
+            for (size_t i = 0; i < bytes; i++) dest[i] = data[(position + i) & (size - 1)];
+        };
+        while (head - tail >= 8) {
+            uint32_t type;
+            uint16_t misc, recordSize;
+            copy(tail, &type, sizeof(type));
+            copy(tail + 4, &misc, sizeof(misc));
+            copy(tail + 6, &recordSize, sizeof(recordSize));
+            (void)misc;
+            if (recordSize < 8 || head - tail < recordSize) break;
+            if (type == RECORD_SAMPLE && recordSize >= 8 + sizeof(LoadSample)) {
+                uint64_t fields[4];
+                copy(tail + 8, fields, sizeof(fields));
+                out.push_back({fields[0], fields[1], fields[2], fields[3]});
+            } else if (type == RECORD_LOST && recordSize >= 24) {
+                uint64_t count;
+                copy(tail + 16, &count, sizeof(count)); // After the 8-byte id
+                lost += count;
+            }
+            tail += recordSize;
+        }
+        return tail;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+    const std::string& method() const { return method_; }
+    bool samplesAllOps() const { return allOps_; } // IBS: samples include stores and non-memory ops
+    uint64_t lost() const { return lost_; } // Samples the kernel dropped on overflow
+
+    void close() {
+#ifdef __linux__
+        if (ring_) munmap(ring_, mapBytes_);
+        if (fd_ >= 0) ::close(fd_);
+        closeLeader();
+#endif
+        ring_ = nullptr;
+        fd_ = -1;
+        method_.clear();
+        allOps_ = false;
+    }
+
+private:
+#ifdef __linux__
+    static perf_event_attr baseAttr(const PerfEventSpec& spec, uint64_t period) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.config1 = spec.config1;
+        attr.config2 = spec.config2;
+        attr.sample_period = period;
+        attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_ADDR | PERF_SAMPLE_WEIGHT | PERF_SAMPLE_DATA_SRC;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return attr;
+    }
+
+    void closeLeader() {
+        if (leader_ >= 0) ::close(leader_);
+        leader_ = -1;
+    }
+#endif
+
+    int fd_ = -1, leader_ = -1;
+    uint8_t* ring_ = nullptr;
+    size_t mapBytes_ = 0;
+    uint64_t lost_ = 0;
+    bool allOps_ = false;
+    std::string method_;
+};
@@ -0,0 +1,10 @@
+// prefetch.h
+// Portable software prefetch hint into all cache levels.
+#pragma once
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+inline void prefetch_read(const void* p) { _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0); }
+#else
+inline void prefetch_read(const void* p) { __builtin_prefetch(p, 0, 3); }
+#endif
@@ -0,0 +1,132 @@
+// resctrl.h
+// Minimal wrapper around the Linux resctrl filesystem (Intel RDT / AMD PQoS):
+// creates a control group, moves threads into it and programs its L3 way mask
+// and memory bandwidth allocation. Everything reports "unavailable" elsewhere.
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class ResctrlGroup {
+public:
+    static constexpr const char* ROOT = "/sys/fs/resctrl";
+
+    // Domain ids and default (unrestricted) value of one schemata resource
+    struct Resource {
+        std::vector<int> domains;
+        uint32_t fullValue = 0;
+    };
+
+    static bool available() {
+        std::ifstream f(std::string(ROOT) + "/schemata");
+        return f.good();
+    }
+
+    // Parses "L3:0=7ff;1=7ff" (hex masks) or "MB:0=100;1=100" (decimal) from
+    // the root group's schemata; returns false when the resource is absent
+    static bool readResource(const std::string& name, Resource& out) {
+        std::ifstream f(std::string(ROOT) + "/schemata");
+        std::string line;
+        while (std::getline(f, line)) {
+            size_t start = line.find_first_not_of(' ');
+            if (start == std::string::npos || line.compare(start, name.size() + 1, name + ":") != 0) {
+                continue;
+            }
+
+            std::stringstream ss(line.substr(start + name.size() + 1));
+            std::string entry;
+            out.domains.clear();
+            while (std::getline(ss, entry, ';')) {
+                size_t eq = entry.find('=');
+                if (eq == std::string::npos) continue;
+                out.domains.push_back(std::stoi(entry.substr(0, eq)));
+                out.fullValue = static_cast<uint32_t>(
+                    std::stoul(entry.substr(eq + 1), nullptr, name == "MB" ? 10 : 16));
+            }
+            return !out.domains.empty();
+        }
+        return false;
+    }
+
+    static uint32_t readInfo(const std::string& path, uint32_t fallback, int base = 10) {
+        std::ifstream f(std::string(ROOT) + "/info/" + path);
+        std::string value;
+        if (!(f >> value)) return fallback;
+        return static_cast<uint32_t>(std::stoul(value, nullptr, base));
+    }
+
+    explicit ResctrlGroup(const std::string& name) : path_(std::string(ROOT) + "/" + name) {
+#ifdef __linux__
+        created_ = mkdir(path_.c_str(), 0755) == 0;
+        if (!created_) error_ = "cannot create " + path_ + " (needs root and a free CLOSID)";
+#else
+        error_ = "resctrl is Linux-only";
+#endif
+    }
+
+    // Removing the group moves its tasks back to the default group
+    ~ResctrlGroup() {
+#ifdef __linux__
+        if (created_) rmdir(path_.c_str());
+#endif
+    }
+
+    ResctrlGroup(const ResctrlGroup&) = delete;
+    ResctrlGroup& operator=(const ResctrlGroup&) = delete;
+
+    bool ok() const { return created_; }
+    const std::string& error() const { return error_; }
+
+    bool addCurrentThread() {
+#ifdef __linux__
+        return write("tasks", std::to_string(static_cast<long>(syscall(SYS_gettid))));
+#else
+        return false;
+#endif
+    }
+
+    bool setL3Mask(const Resource& l3, uint32_t mask) {
+        std::ostringstream line;
+        line << "L3:";
+        for (size_t i = 0; i < l3.domains.size(); i++) {
+            line << (i ? ";" : "") << l3.domains[i] << "=" << std::hex << mask << std::dec;
+        }
+        return write("schemata", line.str());
+    }
+
+    bool setMemBandwidth(const Resource& mb, uint32_t value) {
+        std::ostringstream line;
+        line << "MB:";
+        for (size_t i = 0; i < mb.domains.size(); i++) {
+            line << (i ? ";" : "") << mb.domains[i] << "=" << value;
+        }
+        return write("schemata", line.str());
+    }
+
+private:
+    bool write(const std::string& file, const std::string& value) {
+        std::ofstream f(path_ + "/" + file);
+        f << value << "\n";
+        f.flush();
+        if (f.good()) return true;
+
+        // The kernel explains rejected schemata writes in last_cmd_status
+        std::ifstream status(std::string(ROOT) + "/info/last_cmd_status");
+        std::getline(status, error_);
+        error_ = "write to " + file + " failed: " + error_;
+        return false;
+    }
+
+    std::string path_;
+    std::string error_;
+    bool created_ = false;
+};
@@ -0,0 +1,260 @@
+// reuse_distance.h
+// Index streams with a controlled LRU stack (reuse) distance: the number of
+// distinct elements touched between two accesses to the same element. An
+// access at distance d re-touches the (d+1)-th most recently used element,
+// so on a fully associative LRU cache it hits exactly when d + 1 elements fit.
+// generate_reuse_stream produces streams with a chosen distance distribution;
+// ShardsAnalyzer estimates the distances (and miss ratio curve) of any stream.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// "fixed:D", "uniform:MIN:MAX" or "histogram:PATH", where the file has one
+// "distance weight" pair per line (comma or space separated, # comments)
+class ReuseDistribution {
+public:
+    // False (with `error`) when `spec` is malformed or the histogram is unreadable
+    bool parse(const std::string& spec, std::string& error) {
+        size_t colon = spec.find(':');
+        std::string kind = spec.substr(0, colon), rest = colon == std::string::npos ? "" : spec.substr(colon + 1);
+        distances_.clear();
+        weights_.clear();
+        try {
+            if (kind == "fixed" && !rest.empty()) {
+                lo_ = hi_ = std::stoull(rest);
+            } else if (kind == "uniform" && rest.find(':') != std::string::npos) {
+                lo_ = std::stoull(rest.substr(0, rest.find(':')));
+                hi_ = std::stoull(rest.substr(rest.find(':') + 1));
+                if (hi_ < lo_) throw std::invalid_argument("range");
+            } else if (kind == "histogram" && !rest.empty()) {
+                std::ifstream file(rest);
+                if (!file) {
+                    error = "cannot read " + rest;
+                    return false;
+                }
+                std::string line;
+                while (std::getline(file, line)) {
+                    line = line.substr(0, line.find('#'));
+                    std::replace(line.begin(), line.end(), ',', ' ');
+                    std::istringstream fields(line);
+                    size_t distance;
+                    double weight;
+                    if (!(fields >> distance)) continue;
+                    if (!(fields >> weight) || weight < 0.0) throw std::invalid_argument("weight");
+                    distances_.push_back(distance);
+                    weights_.push_back(weight);
+                }
+                if (distances_.empty()) throw std::invalid_argument("empty");
+                histogram_ = std::discrete_distribution<size_t>(weights_.begin(), weights_.end());
+            } else {
+                throw std::invalid_argument("kind");
+            }
+        } catch (const std::logic_error&) {
+            error = "expected fixed:D, uniform:MIN:MAX or histogram:PATH, got " + spec;
+            return false;
+        }
+        kind_ = kind;
+        return true;
+    }
+
+    static ReuseDistribution fixed(size_t distance) {
+        ReuseDistribution dist;
+        dist.lo_ = dist.hi_ = distance;
+        return dist;
+    }
+
+    template<typename Rng>
+    size_t draw(Rng& rng) {
+        if (kind_ == "uniform") return std::uniform_int_distribution<size_t>(lo_, hi_)(rng);
+        if (kind_ == "histogram") return distances_[histogram_(rng)];
+        return lo_;
+    }
+
+    size_t maxDistance() const {
+        return kind_ == "histogram" ? *std::max_element(distances_.begin(), distances_.end()) : hi_;
+    }
+
+    // Fraction of accesses at distance >= `distance` (misses of an LRU cache holding `distance` elements)
+    double fractionAtLeast(size_t distance) const {
+        if (kind_ == "histogram") {
+            double total = 0.0, at = 0.0;
+            for (size_t i = 0; i < distances_.size(); i++) {
+                total += weights_[i];
+                if (distances_[i] >= distance) at += weights_[i];
+            }
+            return total > 0.0 ? at / total : 0.0;
+        }
+        if (distance <= lo_) return 1.0;
+        if (distance > hi_) return 0.0;
+        return static_cast<double>(hi_ - distance + 1) / static_cast<double>(hi_ - lo_ + 1);
+    }
+
+private:
+    std::string kind_ = "fixed";
+    size_t lo_ = 0, hi_ = 0;
+    std::vector<size_t> distances_;
+    std::vector<double> weights_;
+    std::discrete_distribution<size_t> histogram_;
+};
+
+struct ReuseStream {
+    std::vector<uint32_t> setup;  // Replays the initial LRU stack, least recent first
+    std::vector<uint32_t> stream; // Accesses with the requested distances
+};
+
+// Generates `length` accesses over element ids [0, elements): each drawn
+// distance d picks the element at depth d of an LRU stack that `setup`
+// establishes, capped at the stack depth (min(elements, max distance + 1)).
+// A Fenwick tree over last-access times finds depth d in O(log n)
+template<typename Rng>
+ReuseStream generate_reuse_stream(ReuseDistribution& dist, size_t elements, size_t length, Rng& rng) {
+    ReuseStream out;
+    const size_t live = std::max<size_t>(1, std::min(elements, dist.maxDistance() + 1));
+    const size_t slots = live + length;
+    std::vector<uint32_t> tree(slots + 1, 0), owner(slots);
+    auto add = [&](size_t time, int delta) {
+        for (size_t i = time + 1; i <= slots; i += i & (0 - i)) tree[i] += static_cast<uint32_t>(delta);
+    };
+    // Time holding the k-th (1-based) oldest live element
+    size_t top = 1;
+    while (top * 2 <= slots) top *= 2;
+    auto kth = [&](size_t k) {
+        size_t position = 0;
+        for (size_t step = top; step; step /= 2) {
+            if (position + step <= slots && tree[position + step] < k) {
+                position += step;
+                k -= tree[position];
+            }
+        }
+        return position; // 0-based time
+    };
+
+    // Distinct elements scattered over the id range so depth is not address order
+    std::vector<uint32_t> ids(elements);
+    for (size_t e = 0; e < elements; e++) ids[e] = static_cast<uint32_t>(e);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    out.setup.assign(ids.begin(), ids.begin() + live);
+    for (size_t t = 0; t < live; t++) {
+        owner[t] = out.setup[t];
+        add(t, 1);
+    }
+
+    out.stream.resize(length);
+    for (size_t j = 0; j < length; j++) {
+        size_t depth = std::min(dist.draw(rng), live - 1);
+        size_t time = kth(live - depth);
+        size_t now = live + j;
+        owner[now] = owner[time];
+        add(time, -1);
+        add(now, 1);
+        out.stream[j] = owner[now];
+    }
+    return out;
+}
+
+// Miss ratio curves from sampled stack distances (SHARDS, fixed rate): a
+// line is tracked only when a hash of it falls below rate * 2^24, so the
+// sampled lines form a spatially uniform subset; stack distances measured
+// among them are scaled by 1 / rate. Rate 1 gives exact distances
+class ShardsAnalyzer {
+public:
+    explicit ShardsAnalyzer(double rate = 0.01)
+        : rate_(std::min(1.0, std::max(1e-6, rate))),
+          threshold_(static_cast<uint64_t>(rate_ * static_cast<double>(HASH_RANGE))) {
+        resize(1 << 16);
+    }
+
+    void access(uint64_t line) {
+        total_++;
+        if (hash(line) >= threshold_) return;
+        if (time_ == alive_.size()) resize(2 * alive_.size());
+        size_t now = time_++;
+        auto found = last_.find(line);
+        if (found == last_.end()) {
+            cold_++;
+            last_.emplace(line, now);
+        } else {
+            size_t previous = found->second;
+            // Distinct sampled lines touched since: live times after `previous`
+            size_t newer = last_.size() - prefix(previous);
+            distances_.push_back(static_cast<uint64_t>(static_cast<double>(newer) / rate_));
+            add(previous, -1);
+            alive_[previous] = 0;
+            found->second = now;
+        }
+        add(now, 1);
+        alive_[now] = 1;
+        sorted_ = false;
+    }
+
+    // Estimated miss ratio of a fully associative LRU cache of each size (in lines)
+    std::vector<double> missRatioCurve(const std::vector<size_t>& sizes) {
+        if (!sorted_) std::sort(distances_.begin(), distances_.end());
+        sorted_ = true;
+        // SHARDS-adj: normalise by the expected sample count rather than the
+        // actual one, so a hot line that happens to be sampled (or missed)
+        // does not skew the whole curve; the difference counts as hits
+        std::vector<double> curve;
+        double expected = static_cast<double>(total_) * static_cast<double>(threshold_) / HASH_RANGE;
+        for (size_t size : sizes) {
+            size_t far = distances_.end() - std::lower_bound(distances_.begin(), distances_.end(), size);
+            double misses = static_cast<double>(cold_ + far);
+            curve.push_back(expected > 0.0 ? std::min(1.0, misses / expected) : 0.0);
+        }
+        return curve;
+    }
+
+    size_t accesses() const { return total_; }
+    size_t sampledAccesses() const { return cold_ + distances_.size(); }
+    double rate() const { return rate_; }
+
+private:
+    static constexpr uint64_t HASH_RANGE = 1 << 24;
+
+    static uint64_t hash(uint64_t x) { // splitmix64 finalizer, top 24 bits
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return (x ^ (x >> 31)) >> 40;
+    }
+
+    // Number of live times at or before `time`
+    size_t prefix(size_t time) const {
+        size_t count = 0;
+        for (size_t i = time + 1; i > 0; i -= i & (0 - i)) count += tree_[i];
+        return count;
+    }
+
+    void add(size_t time, int delta) {
+        for (size_t i = time + 1; i < tree_.size(); i += i & (0 - i)) tree_[i] += static_cast<uint32_t>(delta);
+    }
+
+    // Rebuilds the Fenwick tree over `slots` times from the live flags
+    void resize(size_t slots) {
+        alive_.resize(slots, 0);
+        tree_.assign(slots + 1, 0);
+        for (size_t i = 1; i <= slots; i++) {
+            tree_[i] += alive_[i - 1];
+            size_t parent = i + (i & (0 - i));
+            if (parent <= slots) tree_[parent] += tree_[i];
+        }
+    }
+
+    double rate_;
+    uint64_t threshold_;
+    size_t total_ = 0, cold_ = 0, time_ = 0;
+    bool sorted_ = true;
+    std::unordered_map<uint64_t, size_t> last_;
+    std::vector<uint8_t> alive_;
+    std::vector<uint32_t> tree_;
+    std::vector<uint64_t> distances_;
+};
@@ -5,6 +5,44 @@ import matplotlib.pyplot as plt
 import os
 import sys
 import shutil
+import json
+import socket
+import argparse
+
+DEFAULT_SOCKET = '/tmp/memory_benchmark.sock'
+
+class BenchmarkClient:
+    """Client for a running `memory_benchmark_cpp server` daemon"""
+    def __init__(self, socket_path=DEFAULT_SOCKET, timeout=60.0):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.settimeout(timeout)
+        self.sock.connect(socket_path)
+        self.stream = self.sock.makefile('rw')
+    
+    def request(self, spec):
+        """Send one experiment spec and return the decoded JSON reply"""
+        self.stream.write(json.dumps(spec) + '\n')
+        self.stream.flush()
+        reply = self.stream.readline()
+        if not reply:
+            raise ConnectionError("Server closed the connection")
+        return json.loads(reply)
+    
+    def info(self):
+        return self.request({'cmd': 'info'})
+    
+    def run_pattern(self, pattern, iterations=10, warmup=3, core=None):
+        spec = {'pattern': pattern, 'iterations': iterations, 'warmup': warmup}
+        if core is not None:
+            spec['core'] = core
+        return self.request(spec)
+    
+    def shutdown(self):
+        return self.request({'cmd': 'shutdown'})
+    
+    def close(self):
+        self.stream.close()
+        self.sock.close()
 
 class CompleteBenchmarkRunner:
     def __init__(self):
@@ -68,13 +106,13 @@ class CompleteBenchmarkRunner:
             print(f"[ERROR] Error: {e}")
             return False
     
-    def compile_and_run_cpp(self):
-        """Compile and run C++ version"""
+    def compile_cpp(self):
+        """Compile the C++ version; returns the binary path or None"""
         compilers = self.find_compilers()
         
         if not compilers['cpp']:
             print("[ERROR] C++ compiler (g++) not found")
-            return False
+            return None
         
         print("Compiling C++ version...")
         
@@ -83,18 +121,25 @@ class CompleteBenchmarkRunner:
         
         if not os.path.exists(source_file):
             print(f"[ERROR] {source_file} not found")
-            return False
+            return None
+        
+        compile_cmd = ['g++', '-O3', '-std=c++17', '-Wall', '-pthread', source_file, '-o', output_file]
         
-        compile_cmd = ['g++', '-O3', '-std=c++17', '-Wall', source_file, '-o', output_file]
+        result = subprocess.run(compile_cmd, capture_output=True, text=True)
+        if result.returncode != 0:
+            print(f"[ERROR] C++ compilation failed: {result.stderr}")
+            return None
         
+        print("[SUCCESS] C++ compilation successful")
+        return output_file
+    
+    def compile_and_run_cpp(self):
+        """Compile and run C++ version"""
         try:
-            result = subprocess.run(compile_cmd, capture_output=True, text=True)
-            if result.returncode != 0:
-                print(f"[ERROR] C++ compilation failed: {result.stderr}")
+            output_file = self.compile_cpp()
+            if not output_file:
                 return False
             
-            print("[SUCCESS] C++ compilation successful")
-            
             # Run benchmark
             result = subprocess.run([output_file], capture_output=True, text=True, cwd='.')
             if result.returncode == 0:
@@ -226,6 +271,77 @@ class CompleteBenchmarkRunner:
             df_relative.to_csv('relative_performance_results.csv')
         print("Results saved to CSV files")
     
+    def run_server_sweep(self, socket_path, patterns=None, iterations=10, core=None):
+        """Query a running benchmark server instead of compiling and launching binaries"""
+        try:
+            client = BenchmarkClient(socket_path)
+        except OSError as e:
+            print(f"[ERROR] Cannot connect to server at {socket_path}: {e}")
+            return False
+        
+        try:
+            info = client.info()
+            for pattern in patterns or info['patterns']:
+                reply = client.run_pattern(pattern, iterations=iterations, core=core)
+                if 'error' in reply:
+                    print(f"[ERROR] {pattern}: {reply['error']}")
+                    continue
+                print(f"{pattern:>12}: {reply['median_ms']:8.2f} ms  ({reply['ns_per_access']:.2f} ns/access)")
+                self.results.setdefault(pattern, {})['C++ (server)'] = reply['median_ms']
+        finally:
+            client.close()
+        
+        # Same CSV files and chart as a full run
+        if self.results:
+            self.create_comparative_chart()
+        return True
+    
+    def run_topdown(self, cpu=None):
+        """Run the top-down mode and chart the level 1 and memory-bound breakdown per pattern"""
+        output_file = self.compile_cpp()
+        if not output_file:
+            return False
+        
+        cmd = [os.path.abspath(output_file), 'topdown'] + (['--cpu', cpu] if cpu else [])
+        result = subprocess.run(cmd, capture_output=True, text=True)
+        print(result.stdout)
+        if result.returncode != 0:
+            print(f"[ERROR] topdown failed: {result.stderr}")
+            return False
+        
+        csv_lines = result.stdout.split('CSV_OUTPUT:', 1)[-1].strip().splitlines()
+        rows = [line.split(',') for line in csv_lines]
+        df = pd.DataFrame(rows[1:], columns=rows[0]).set_index('Pattern')
+        df = df.apply(pd.to_numeric, errors='coerce')
+        df.to_csv('topdown_results.csv')
+        if df['Frontend'].isna().all():
+            print("[INFO] Top-down counters unavailable; timings saved to topdown_results.csv")
+            return True
+        
+        level1 = df[['Frontend', 'Bad_speculation', 'Retiring', 'Memory', 'Core']] * 100
+        memory = df[['L1', 'L2', 'L3', 'DRAM', 'Store']].dropna(axis=1, how='all') * 100
+        
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(16, 6))
+        level1.plot(kind='bar', stacked=True, ax=ax1, width=0.8,
+                    color=['#2E86AB', '#C73E1D', '#4CAF50', '#F18F01', '#A23B72'])
+        ax1.set_title('Top-Down Level 1 (Backend = Memory + Core)', fontsize=14, fontweight='bold')
+        ax1.set_ylabel('% of issue slots', fontsize=12)
+        ax1.set_ylim(0, 100)
+        ax1.grid(True, axis='y', alpha=0.3)
+        ax1.tick_params(axis='x', rotation=45)
+        
+        memory.plot(kind='bar', stacked=True, ax=ax2, width=0.8)
+        ax2.set_title('Memory Bound by Level', fontsize=14, fontweight='bold')
+        ax2.set_ylabel('% of issue slots', fontsize=12)
+        ax2.grid(True, axis='y', alpha=0.3)
+        ax2.tick_params(axis='x', rotation=45)
+        
+        plt.tight_layout()
+        plt.savefig('topdown_breakdown.png', dpi=300, bbox_inches='tight')
+        print("Chart saved: topdown_breakdown.png")
+        plt.show()
+        return True
+    
     def run_complete_suite(self):
         """Run both C and C++ benchmarks"""
         print("=== COMPLETE Memory Access Benchmark Suite ===\n")
@@ -260,5 +376,20 @@ class CompleteBenchmarkRunner:
             print("\nNo successful benchmarks")
 
 if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Memory access pattern benchmark runner")
+    parser.add_argument('--server', metavar='SOCKET', nargs='?', const=DEFAULT_SOCKET,
+                        help="query a running 'memory_benchmark_cpp server' instead of rebuilding")
+    parser.add_argument('--patterns', nargs='+', help="patterns to query in server mode (default: all)")
+    parser.add_argument('--iterations', type=int, default=10, help="timed iterations per pattern")
+    parser.add_argument('--core', type=int, help="core to pin the measurement to in server mode")
+    parser.add_argument('--topdown', action='store_true', help="run the top-down mode and chart its breakdown")
+    parser.add_argument('--cpu', help="top-down event table when CPU detection fails (e.g. zen4)")
+    args = parser.parse_args()
+    
     runner = CompleteBenchmarkRunner()
-    runner.run_complete_suite()
+    if args.topdown:
+        runner.run_topdown(args.cpu)
+    elif args.server:
+        runner.run_server_sweep(args.server, args.patterns, args.iterations, args.core)
+    else:
+        runner.run_complete_suite()
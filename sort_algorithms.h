@@ -0,0 +1,380 @@
+// sort_algorithms.h
+// Sorting kernels for the sort benchmark. All sort a std::vector<T> by an
+// unsigned 32-bit key extracted with `key(record)`; radix and sample sort use
+// a caller-provided scratch vector so allocation stays out of the timing.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Stable counting-sort passes over bytes [0, bytes) of the key, ping-ponging
+// between src and dst; returns whichever buffer holds the result
+template<typename T, typename KeyFn>
+T* radix_lsd_bytes(T* src, T* dst, size_t n, KeyFn key, int bytes) {
+    std::vector<size_t> counts(4 * 256, 0);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t k = key(src[i]);
+        for (int d = 0; d < bytes; d++) counts[d * 256 + ((k >> (8 * d)) & 0xff)]++;
+    }
+
+    for (int d = 0; d < bytes; d++) {
+        size_t* count = &counts[d * 256];
+        if (n == 0 || count[(key(src[0]) >> (8 * d)) & 0xff] == n) continue; // All keys share this byte
+
+        size_t offsets[256], sum = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += count[b];
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[offsets[(key(src[i]) >> (8 * d)) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    return src;
+}
+
+template<typename T, typename KeyFn>
+void lsd_radix_sort(std::vector<T>& data, std::vector<T>& tmp, KeyFn key) {
+    tmp.resize(data.size());
+    if (radix_lsd_bytes(data.data(), tmp.data(), data.size(), key, 4) != data.data()) data.swap(tmp);
+}
+
+// MSD radix sort: the first pass scatters on the top byte through one cache
+// line of staging buffer per bucket (software write-combining), so the 256-way
+// scatter writes whole lines instead of touching 256 partial lines per record.
+// Buckets then finish with LSD passes over the remaining three bytes.
+template<typename T, typename KeyFn>
+void msd_radix_sort_wc(std::vector<T>& data, std::vector<T>& tmp, KeyFn key) {
+    constexpr size_t PER_LINE = sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+    size_t n = data.size();
+    tmp.resize(n);
+
+    size_t counts[256] = {}, offsets[256], starts[257];
+    for (size_t i = 0; i < n; i++) counts[key(data[i]) >> 24]++;
+    starts[0] = 0;
+    for (int b = 0; b < 256; b++) {
+        offsets[b] = starts[b];
+        starts[b + 1] = starts[b] + counts[b];
+    }
+
+    struct alignas(64) Line { T records[PER_LINE]; };
+    std::vector<Line> lines(256);
+    size_t fill[256] = {};
+    for (size_t i = 0; i < n; i++) {
+        uint32_t b = key(data[i]) >> 24;
+        lines[b].records[fill[b]++] = data[i];
+        if (fill[b] == PER_LINE) {
+            std::copy(lines[b].records, lines[b].records + PER_LINE, tmp.data() + offsets[b]);
+            offsets[b] += PER_LINE;
+            fill[b] = 0;
+        }
+    }
+    for (int b = 0; b < 256; b++) {
+        std::copy(lines[b].records, lines[b].records + fill[b], tmp.data() + offsets[b]);
+    }
+
+    for (int b = 0; b < 256; b++) {
+        size_t start = starts[b], len = starts[b + 1] - starts[b];
+        T* sorted;
+        if (len <= 64) {
+            std::sort(tmp.data() + start, tmp.data() + start + len,
+                      [&](const T& x, const T& y) { return key(x) < key(y); });
+            sorted = tmp.data() + start;
+        } else {
+            sorted = radix_lsd_bytes(tmp.data() + start, data.data() + start, len, key, 3);
+        }
+        if (sorted != data.data() + start) std::copy(sorted, sorted + len, data.data() + start);
+    }
+}
+
+// Pattern-defeating quicksort in the style of Orson Peters' pdqsort: ninther
+// pivots, branchless block partitioning, partial insertion sort on already
+// partitioned ranges and a heapsort fallback after too many bad partitions.
+// The separate equal-key partition of the original is omitted.
+constexpr size_t PDQ_INSERTION_THRESHOLD = 24;
+constexpr size_t PDQ_NINTHER_THRESHOLD = 128;
+constexpr size_t PDQ_BLOCK = 64;
+
+template<typename It, typename Less>
+void pdq_insertion_sort(It begin, It end, Less less) {
+    if (begin == end) return;
+    for (It cur = begin + 1; cur != end; ++cur) {
+        auto tmp = std::move(*cur);
+        It sift = cur;
+        for (; sift != begin && less(tmp, *(sift - 1)); --sift) *sift = std::move(*(sift - 1));
+        *sift = std::move(tmp);
+    }
+}
+
+// Insertion sort that gives up after a few moves; true if the range is now sorted
+template<typename It, typename Less>
+bool pdq_partial_insertion_sort(It begin, It end, Less less) {
+    if (begin == end) return true;
+    size_t moves = 0;
+    for (It cur = begin + 1; cur != end; ++cur) {
+        if (!less(*cur, *(cur - 1))) continue;
+        auto tmp = std::move(*cur);
+        It sift = cur;
+        for (; sift != begin && less(tmp, *(sift - 1)); --sift) *sift = std::move(*(sift - 1));
+        *sift = std::move(tmp);
+        moves += static_cast<size_t>(cur - sift);
+        if (moves > 8) return false;
+    }
+    return true;
+}
+
+template<typename It, typename Less>
+void pdq_sort3(It a, It b, It c, Less less) {
+    if (less(*b, *a)) std::iter_swap(a, b);
+    if (less(*c, *b)) std::iter_swap(b, c);
+    if (less(*b, *a)) std::iter_swap(a, b);
+}
+
+template<typename It>
+void pdq_swap_offsets(It first, It last, const unsigned char* offsetsL, const unsigned char* offsetsR,
+                      size_t num, bool useSwaps) {
+    if (useSwaps) {
+        // Equal counts on both sides: the cyclic permutation below would need an extra move
+        for (size_t i = 0; i < num; i++) std::iter_swap(first + offsetsL[i], last - offsetsR[i]);
+    } else if (num > 0) {
+        It l = first + offsetsL[0];
+        It r = last - offsetsR[0];
+        auto tmp = std::move(*l);
+        *l = std::move(*r);
+        for (size_t i = 1; i < num; i++) {
+            l = first + offsetsL[i];
+            *r = std::move(*l);
+            r = last - offsetsR[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(tmp);
+    }
+}
+
+// Partitions [begin, end) around *begin; returns the pivot position and
+// whether the range was already partitioned. Requires an element >= pivot at end - 1.
+template<typename It, typename Less>
+std::pair<It, bool> pdq_partition_right(It begin, It end, Less less) {
+    auto pivot = std::move(*begin);
+    It first = begin, last = end;
+
+    while (less(*++first, pivot)) {}
+    if (first - 1 == begin) {
+        while (first < last && !less(*--last, pivot)) {}
+    } else {
+        while (!less(*--last, pivot)) {}
+    }
+
+    // The first misplaced pair is the same element: nothing to move
+    if (first >= last) {
+        It pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return {pivotPos, true};
+    }
+    std::iter_swap(first, last);
+    ++first;
+
+    // Classify blocks of elements into offset buffers without branches, then swap misplaced pairs
+    alignas(64) unsigned char offsetsL[PDQ_BLOCK], offsetsR[PDQ_BLOCK];
+    size_t numL = 0, numR = 0, startL = 0, startR = 0;
+    while (last - first > static_cast<std::ptrdiff_t>(2 * PDQ_BLOCK)) {
+        if (numL == 0) {
+            startL = 0;
+            It it = first;
+            for (unsigned char i = 0; i < PDQ_BLOCK; i++, ++it) {
+                offsetsL[numL] = i;
+                numL += !less(*it, pivot);
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            It it = last;
+            for (unsigned char i = 0; i < PDQ_BLOCK; i++) {
+                offsetsR[numR] = i + 1;
+                numR += less(*--it, pivot);
+            }
+        }
+
+        size_t num = std::min(numL, numR);
+        pdq_swap_offsets(first, last, offsetsL + startL, offsetsR + startR, num, numL == numR);
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) first += PDQ_BLOCK;
+        if (numR == 0) last -= PDQ_BLOCK;
+    }
+
+    // Fewer than two blocks remain: size the final blocks to cover the rest
+    size_t sizeL = 0, sizeR = 0;
+    size_t unknown = static_cast<size_t>(last - first) - ((numR || numL) ? PDQ_BLOCK : 0);
+    if (numR) {
+        sizeL = unknown;
+        sizeR = PDQ_BLOCK;
+    } else if (numL) {
+        sizeL = PDQ_BLOCK;
+        sizeR = unknown;
+    } else {
+        sizeL = unknown / 2;
+        sizeR = unknown - sizeL;
+    }
+
+    if (unknown && !numL) {
+        startL = 0;
+        It it = first;
+        for (unsigned char i = 0; i < sizeL; i++, ++it) {
+            offsetsL[numL] = i;
+            numL += !less(*it, pivot);
+        }
+    }
+    if (unknown && !numR) {
+        startR = 0;
+        It it = last;
+        for (unsigned char i = 0; i < sizeR; i++) {
+            offsetsR[numR] = i + 1;
+            numR += less(*--it, pivot);
+        }
+    }
+
+    size_t num = std::min(numL, numR);
+    pdq_swap_offsets(first, last, offsetsL + startL, offsetsR + startR, num, numL == numR);
+    numL -= num;
+    numR -= num;
+    startL += num;
+    startR += num;
+    if (numL == 0) first += sizeL;
+    if (numR == 0) last -= sizeR;
+
+    // Only one side can have leftovers; move them next to the partition point
+    if (numL) {
+        while (numL--) std::iter_swap(first + offsetsL[startL + numL], --last);
+        first = last;
+    }
+    if (numR) {
+        while (numR--) std::iter_swap(last - offsetsR[startR + numR], first), ++first;
+        last = first;
+    }
+
+    It pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, false};
+}
+
+template<typename It, typename Less>
+void pdq_loop(It begin, It end, Less less, int badAllowed) {
+    while (true) {
+        size_t size = static_cast<size_t>(end - begin);
+        if (size < PDQ_INSERTION_THRESHOLD) {
+            pdq_insertion_sort(begin, end, less);
+            return;
+        }
+
+        // Median of three, or Tukey's ninther for large ranges; leaves the pivot at begin
+        size_t half = size / 2;
+        if (size > PDQ_NINTHER_THRESHOLD) {
+            pdq_sort3(begin, begin + half, end - 1, less);
+            pdq_sort3(begin + 1, begin + (half - 1), end - 2, less);
+            pdq_sort3(begin + 2, begin + (half + 1), end - 3, less);
+            pdq_sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            std::iter_swap(begin, begin + half);
+        } else {
+            pdq_sort3(begin + half, begin, end - 1, less);
+        }
+
+        std::pair<It, bool> part = pdq_partition_right(begin, end, less);
+        It pivotPos = part.first;
+        size_t sizeL = static_cast<size_t>(pivotPos - begin);
+        size_t sizeR = static_cast<size_t>(end - (pivotPos + 1));
+
+        if (sizeL < size / 8 || sizeR < size / 8) {
+            if (--badAllowed == 0) {
+                std::make_heap(begin, end, less);
+                std::sort_heap(begin, end, less);
+                return;
+            }
+            // Break up patterns that produced the bad pivot
+            if (sizeL >= PDQ_INSERTION_THRESHOLD) {
+                std::iter_swap(begin, begin + sizeL / 4);
+                std::iter_swap(pivotPos - 1, pivotPos - sizeL / 4);
+            }
+            if (sizeR >= PDQ_INSERTION_THRESHOLD) {
+                std::iter_swap(pivotPos + 1, pivotPos + (1 + sizeR / 4));
+                std::iter_swap(end - 1, end - sizeR / 4);
+            }
+        } else if (part.second && pdq_partial_insertion_sort(begin, pivotPos, less)
+                   && pdq_partial_insertion_sort(pivotPos + 1, end, less)) {
+            return; // Already-sorted input finishes in linear time
+        }
+
+        pdq_loop(begin, pivotPos, less, badAllowed);
+        begin = pivotPos + 1;
+    }
+}
+
+template<typename T, typename KeyFn>
+void pdq_sort(std::vector<T>& data, KeyFn key) {
+    if (data.size() < 2) return;
+    int log2n = 0;
+    for (size_t n = data.size(); n > 1; n >>= 1) log2n++;
+    pdq_loop(data.begin(), data.end(), [&](const T& x, const T& y) { return key(x) < key(y); }, log2n);
+}
+
+// Parallel sample sort: splitters from a sorted sample define one bucket per
+// thread; threads count and scatter their chunk into tmp, then each sorts one bucket
+template<typename T, typename KeyFn>
+void parallel_sample_sort(std::vector<T>& data, std::vector<T>& tmp, KeyFn key, unsigned threads) {
+    size_t n = data.size();
+    if (n < 2) return;
+    size_t p = std::max(1u, threads);
+    const size_t oversample = 64;
+    tmp.resize(n);
+
+    std::vector<uint32_t> sample;
+    size_t sampleSize = std::min(n, p * oversample);
+    for (size_t i = 0; i < sampleSize; i++) sample.push_back(key(data[i * n / sampleSize]));
+    std::sort(sample.begin(), sample.end());
+    std::vector<uint32_t> splitters;
+    for (size_t b = 1; b < p; b++) splitters.push_back(sample[b * sampleSize / p]);
+    auto bucketOf = [&](const T& r) {
+        return static_cast<size_t>(std::upper_bound(splitters.begin(), splitters.end(), key(r)) - splitters.begin());
+    };
+
+    auto parallelFor = [&](auto body) {
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < p; t++) workers.emplace_back(body, t);
+        body(0);
+        for (auto& w : workers) w.join();
+    };
+
+    // counts[t * p + b]: records of thread t's chunk that land in bucket b
+    std::vector<size_t> counts(p * p, 0), offsets(p * p), bucketStart(p + 1, 0);
+    parallelFor([&](size_t t) {
+        for (size_t i = t * n / p; i < (t + 1) * n / p; i++) counts[t * p + bucketOf(data[i])]++;
+    });
+    size_t sum = 0;
+    for (size_t b = 0; b < p; b++) {
+        bucketStart[b] = sum;
+        for (size_t t = 0; t < p; t++) {
+            offsets[t * p + b] = sum;
+            sum += counts[t * p + b];
+        }
+    }
+    bucketStart[p] = n;
+
+    parallelFor([&](size_t t) {
+        size_t* offset = &offsets[t * p];
+        for (size_t i = t * n / p; i < (t + 1) * n / p; i++) tmp[offset[bucketOf(data[i])]++] = data[i];
+    });
+    parallelFor([&](size_t b) {
+        std::sort(tmp.begin() + bucketStart[b], tmp.begin() + bucketStart[b + 1],
+                  [&](const T& x, const T& y) { return key(x) < key(y); });
+    });
+    data.swap(tmp);
+}
@@ -0,0 +1,167 @@
+// stride_model.h
+// Compact locality model of an index stream, fitted once and then sampled for
+// streams of any length:
+//   stride classes - the most frequent strides from the previous access
+//                    (delta-1) and from the one before it (delta-2, which
+//                    captures two interleaved streams such as Bouncing)
+//   Markov chain   - transition probabilities between those classes
+//   regions        - access popularity of equal slices of the index space,
+//                    used for "other" accesses that match no class; each
+//                    region hands out its slots in a shuffled order before
+//                    repeating any, so a stream that touches every slot once
+//                    (like Random) stays reuse-free
+// Generated indices keep the input's alignment (the gcd of its indices).
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class StrideModel {
+public:
+    static constexpr size_t CLASSES_PER_KIND = 8;
+
+    // Fits the model; `space` is one past the largest index a generated stream may use
+    void fit(const std::vector<size_t>& stream, size_t space, size_t regions = 65536) {
+        granule_ = 0;
+        for (size_t index : stream) granule_ = std::gcd(granule_, index);
+        granule_ = std::max<size_t>(1, std::min(granule_, space));
+        space_ = std::max<size_t>(space / granule_, 1); // In granules from here on
+        regions_ = std::max<size_t>(1, std::min(regions, space_));
+        strides_.clear();
+
+        // Most frequent delta-1 and delta-2 strides, ignoring ones under 0.1% of the stream
+        for (int kind = 1; kind <= 2; kind++) {
+            std::map<int64_t, size_t> counts;
+            for (size_t t = kind; t < stream.size(); t++) counts[delta(stream, t, kind)]++;
+            std::vector<std::pair<size_t, int64_t>> ranked;
+            for (const auto& entry : counts) {
+                if (entry.second * 1000 >= stream.size()) ranked.push_back({entry.second, entry.first});
+            }
+            std::sort(ranked.rbegin(), ranked.rend());
+            for (size_t i = 0; i < ranked.size() && i < CLASSES_PER_KIND; i++) {
+                strides_.push_back({kind, ranked[i].second});
+            }
+        }
+
+        const size_t states = classCount();
+        transitions_.assign(states, std::vector<double>(states, 0.0));
+        regionWeights_.assign(regions_, 0.0);
+        for (size_t t = 0; t < stream.size(); t++) regionWeights_[region(stream[t] / granule_)] += 1.0;
+        if (stream.empty()) regionWeights_.assign(regions_, 1.0);
+        size_t previous = states - 1; // The first access follows no stride
+        for (size_t t = 1; t < stream.size(); t++) {
+            size_t state = classify(stream, t);
+            transitions_[previous][state] += 1.0;
+            previous = state;
+        }
+        for (auto& row : transitions_) {
+            double total = 0.0;
+            for (double count : row) total += count;
+            if (total == 0.0) row.back() = 1.0; // Unseen state: fall back to "other"
+        }
+        start_ = stream.empty() ? 0 : stream.front();
+        buildSamplers();
+    }
+
+    template<typename Rng>
+    std::vector<size_t> generate(size_t length, Rng& rng) {
+        std::vector<size_t> out;
+        out.reserve(length);
+        slotOrder_.clear();
+        slotOrder_.resize(regions_);
+        cursors_.assign(regions_, 0);
+        size_t state = classCount() - 1;
+        for (size_t t = 0; t < length; t++) {
+            if (t == 0) {
+                out.push_back(start_);
+                continue;
+            }
+            state = rows_[state](rng);
+            bool other = state == classCount() - 1 || (strides_[state].kind == 2 && t < 2);
+            if (other) {
+                out.push_back(nextInRegion(regionSampler_(rng), rng) * granule_);
+            } else {
+                // Strides wrap around the index space
+                int64_t span = static_cast<int64_t>(space_ * granule_);
+                int64_t next = (static_cast<int64_t>(out[t - strides_[state].kind]) + strides_[state].stride) % span;
+                out.push_back(static_cast<size_t>(next < 0 ? next + span : next));
+            }
+        }
+        return out;
+    }
+
+    // Fraction of accesses in each class (the last entry is "other") when
+    // `stream` is classified with this model's strides
+    std::vector<double> classHistogram(const std::vector<size_t>& stream) const {
+        std::vector<double> histogram(classCount(), 0.0);
+        for (size_t t = 1; t < stream.size(); t++) histogram[classify(stream, t)] += 1.0;
+        for (double& fraction : histogram) fraction /= std::max<size_t>(1, stream.size() - 1);
+        return histogram;
+    }
+
+    size_t classCount() const { return strides_.size() + 1; }
+
+    std::string className(size_t state) const {
+        if (state + 1 == classCount()) return "other";
+        std::ostringstream name;
+        name << "d" << strides_[state].kind << (strides_[state].stride >= 0 ? "+" : "") << strides_[state].stride;
+        return name.str();
+    }
+
+private:
+    struct StrideClass { int kind; int64_t stride; };
+
+    static int64_t delta(const std::vector<size_t>& stream, size_t t, int kind) {
+        return static_cast<int64_t>(stream[t]) - static_cast<int64_t>(stream[t - kind]);
+    }
+
+    // First matching delta-1 class, then delta-2, else "other"
+    size_t classify(const std::vector<size_t>& stream, size_t t) const {
+        for (int kind = 1; kind <= 2; kind++) {
+            if (t < static_cast<size_t>(kind)) continue;
+            int64_t d = delta(stream, t, kind);
+            for (size_t c = 0; c < strides_.size(); c++) {
+                if (strides_[c].kind == kind && strides_[c].stride == d) return c;
+            }
+        }
+        return classCount() - 1;
+    }
+
+    // `index` and the region bounds are in granules
+    size_t region(size_t index) const { return std::min(regions_ - 1, index * regions_ / space_); }
+
+    template<typename Rng>
+    size_t nextInRegion(size_t r, Rng& rng) {
+        std::vector<uint32_t>& order = slotOrder_[r];
+        if (order.empty()) {
+            for (size_t slot = r * space_ / regions_; slot < (r + 1) * space_ / regions_; slot++) {
+                order.push_back(static_cast<uint32_t>(slot));
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+        }
+        return order[cursors_[r]++ % order.size()];
+    }
+
+    void buildSamplers() {
+        rows_.clear();
+        for (const auto& row : transitions_) rows_.emplace_back(row.begin(), row.end());
+        regionSampler_ = std::discrete_distribution<size_t>(regionWeights_.begin(), regionWeights_.end());
+    }
+
+    size_t granule_ = 1, space_ = 1, regions_ = 1, start_ = 0;
+    std::vector<StrideClass> strides_;
+    std::vector<std::vector<double>> transitions_;
+    std::vector<double> regionWeights_;
+    std::vector<std::discrete_distribution<size_t>> rows_;
+    std::discrete_distribution<size_t> regionSampler_;
+    std::vector<std::vector<uint32_t>> slotOrder_; // Per region, filled on first use
+    std::vector<size_t> cursors_;
+};
@@ -0,0 +1,261 @@
+// topdown.h
+// Top-down microarchitecture analysis (TMA) from raw core events. Every
+// issue slot of the pipeline is attributed to one level 1 category:
+//   frontend bound  - no uop delivered to an empty slot
+//   bad speculation - slot spent on uops that never retire, plus recovery
+//   retiring        - slot spent on a uop that retires
+//   backend bound   - the rest: uops waiting for data or execution units
+// and backend bound splits into memory bound and core bound, with memory
+// bound split further into L1, L2, L3, DRAM and store bound.
+//
+// The events of each CPU family are listed in topdown_tables() as groups, each
+// led by an unhalted-cycles event. A group is scheduled as a unit, so rates
+// per cycle within it are exact under multiplexing, and the formulas only
+// combine those per-cycle rates, never raw counts from different groups.
+// Event terms are encoded with the PMU's sysfs format, so the tables hold the
+// names the vendor documents (event, umask, cmask).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "perf_counters.h"
+
+struct TopdownEvent {
+    const char* role;  // Name used by the formulas
+    const char* terms; // sysfs terms for the core PMU
+};
+
+struct TopdownTable {
+    const char* name;
+    const char* vendor; // "intel" or "amd"
+    double width;       // Issue (Intel) or dispatch (AMD) slots per cycle
+    std::vector<std::vector<TopdownEvent>> groups; // Each group starts with "cycles"
+};
+
+// Legacy TMA events (the Intel TMA metrics spreadsheet and the perf pipeline
+// metrics for AMD). Ice Lake and later also expose fixed-counter topdown
+// metrics, but the legacy events work on every core listed here
+inline const std::vector<TopdownTable>& topdown_tables() {
+    using Groups = std::vector<std::vector<TopdownEvent>>;
+    // Skylake through Tiger Lake and Rocket Lake share one encoding
+    static const Groups skylake = {
+        {{"cycles", "event=0x3c"},
+         {"fe_undelivered", "event=0x9c,umask=0x01"}, // IDQ_UOPS_NOT_DELIVERED.CORE
+         {"uops_issued", "event=0x0e,umask=0x01"},    // UOPS_ISSUED.ANY
+         {"uops_retired", "event=0xc2,umask=0x02"},   // UOPS_RETIRED.RETIRE_SLOTS
+         {"recovery", "event=0x0d,umask=0x01"}},      // INT_MISC.RECOVERY_CYCLES
+        {{"cycles", "event=0x3c"},
+         {"stalls_total", "event=0xa3,umask=0x04,cmask=4"}, // CYCLE_ACTIVITY.STALLS_TOTAL
+         {"stalls_mem", "event=0xa3,umask=0x14,cmask=20"},  // CYCLE_ACTIVITY.STALLS_MEM_ANY
+         {"stores", "event=0xa6,umask=0x40"},               // EXE_ACTIVITY.BOUND_ON_STORES
+         {"ports_1", "event=0xa6,umask=0x02"}},             // EXE_ACTIVITY.1_PORTS_UTIL
+        {{"cycles", "event=0x3c"},
+         {"stalls_l1d_miss", "event=0xa3,umask=0x0c,cmask=12"}, // CYCLE_ACTIVITY.STALLS_L1D_MISS
+         {"stalls_l2_miss", "event=0xa3,umask=0x05,cmask=5"},   // CYCLE_ACTIVITY.STALLS_L2_MISS
+         {"stalls_l3_miss", "event=0xa3,umask=0x06,cmask=6"}}}; // CYCLE_ACTIVITY.STALLS_L3_MISS
+    static const Groups goldenCove = {
+        {{"cycles", "event=0x3c"},
+         {"fe_undelivered", "event=0x9c,umask=0x01"}, // IDQ_UOPS_NOT_DELIVERED.CORE
+         {"uops_issued", "event=0xae,umask=0x01"},    // UOPS_ISSUED.ANY
+         {"uops_retired", "event=0xc2,umask=0x02"},   // UOPS_RETIRED.SLOTS
+         {"recovery", "event=0xad,umask=0x01"}},      // INT_MISC.RECOVERY_CYCLES
+        {{"cycles", "event=0x3c"},
+         {"stalls_total", "event=0xa3,umask=0x04,cmask=4"}, // CYCLE_ACTIVITY.STALLS_TOTAL
+         {"stalls_mem", "event=0xa6,umask=0x21,cmask=5"},   // EXE_ACTIVITY.BOUND_ON_LOADS
+         {"stores", "event=0xa6,umask=0x40,cmask=2"},       // EXE_ACTIVITY.BOUND_ON_STORES
+         {"ports_1", "event=0xa6,umask=0x02"}},             // EXE_ACTIVITY.1_PORTS_UTIL
+        {{"cycles", "event=0x3c"},
+         {"stalls_l1d_miss", "event=0x47,umask=0x03,cmask=3"}, // MEMORY_ACTIVITY.STALLS_L1D_MISS
+         {"stalls_l2_miss", "event=0x47,umask=0x05,cmask=5"},  // MEMORY_ACTIVITY.STALLS_L2_MISS
+         {"stalls_l3_miss", "event=0x47,umask=0x09,cmask=9"}}}; // MEMORY_ACTIVITY.STALLS_L3_MISS
+    // Zen 4 and Zen 5 share one encoding
+    static const Groups zen = {
+        {{"cycles", "event=0x76"},                        // ls_not_halted_cyc
+         {"fe_slots", "event=0x1a0,umask=0x01"},          // de_no_dispatch_per_slot.no_ops_from_frontend
+         {"be_slots", "event=0x1a0,umask=0x1e"},          // de_no_dispatch_per_slot.backend_stalls
+         {"ops_dispatched", "event=0xaa,umask=0x07"},     // de_src_op_disp.all
+         {"ops_retired", "event=0xc1"}},                  // ex_ret_ops
+        {{"cycles", "event=0x76"},
+         {"not_complete", "event=0xd6,umask=0x02"},       // ex_no_retire.not_complete
+         {"load_not_complete", "event=0xd6,umask=0xa2"}}, // ex_no_retire.load_not_complete
+        {{"cycles", "event=0x76"},
+         {"fill_l2", "event=0x44,umask=0x01"},            // ls_any_fills_from_sys.local_l2
+         {"fill_l3", "event=0x44,umask=0x16"},            // local_ccx | near_cache | far_cache
+         {"fill_dram", "event=0x44,umask=0x48"}}};        // dram_io_near | dram_io_far
+    static const std::vector<TopdownTable> tables = {
+        {"skylake", "intel", 4.0, skylake},       // Skylake, Kaby/Coffee/Comet Lake, Cascade Lake
+        {"icelake", "intel", 5.0, skylake},       // Ice Lake, Tiger Lake, Rocket Lake
+        {"goldencove", "intel", 6.0, goldenCove}, // Alder/Raptor Lake P-cores, Sapphire/Emerald Rapids
+        {"zen4", "amd", 6.0, zen},                // Ryzen 7000, EPYC 9004
+        {"zen5", "amd", 8.0, zen},                // Ryzen 9000, EPYC 9005
+    };
+    return tables;
+}
+
+inline const TopdownTable* topdown_table(const std::string& name) {
+    for (const auto& table : topdown_tables()) {
+        if (name == table.name) return &table;
+    }
+    return nullptr;
+}
+
+// Table for the running CPU from /proc/cpuinfo (vendor, family, model), or null
+inline const TopdownTable* topdown_table_for_cpu() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line, vendor;
+    int family = -1, model = -1;
+    while (std::getline(cpuinfo, line) && (vendor.empty() || family < 0 || model < 0)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+        std::string value = line.substr(std::min(line.size(), colon + 2));
+        if (key == "vendor_id") vendor = value;
+        else if (key == "cpu family") family = std::stoi(value);
+        else if (key == "model") model = std::stoi(value);
+    }
+    if (vendor == "GenuineIntel" && family == 6) {
+        for (int m : {0x4e, 0x5e, 0x55, 0x8e, 0x9e, 0xa5, 0xa6}) {
+            if (model == m) return topdown_table("skylake");
+        }
+        for (int m : {0x7d, 0x7e, 0x6a, 0x6c, 0x8c, 0x8d, 0xa7}) {
+            if (model == m) return topdown_table("icelake");
+        }
+        for (int m : {0x97, 0x9a, 0xb7, 0xba, 0xbf, 0x8f, 0xcf}) {
+            if (model == m) return topdown_table("goldencove");
+        }
+    } else if (vendor == "AuthenticAMD") {
+        if (family == 0x1a) return topdown_table("zen5");
+        if (family == 0x19 && ((model >= 0x10 && model <= 0x1f) || (model >= 0x60 && model <= 0x7f) ||
+                               (model >= 0xa0 && model <= 0xaf))) {
+            return topdown_table("zen4");
+        }
+    }
+    return nullptr;
+}
+
+// Shares of all issue slots; the memory split sums to `memory`. NaN where the
+// table has no events for a metric (AMD has no L1 or store bound)
+struct TopdownBreakdown {
+    double frontend, badSpeculation, retiring, backend;
+    double memory, core;
+    double l1, l2, l3, dram, store;
+};
+
+// Level 1 and 2 from per-cycle event rates (count / cycles of the event's group)
+inline TopdownBreakdown topdown_compute(const TopdownTable& table, const std::map<std::string, double>& perCycle) {
+    auto rate = [&](const char* role) {
+        auto found = perCycle.find(role);
+        return found == perCycle.end() ? std::nan("") : found->second;
+    };
+    auto clamp01 = [](double x) { return std::isnan(x) ? x : std::min(1.0, std::max(0.0, x)); };
+    const double nan = std::nan(""), w = table.width;
+    TopdownBreakdown b{nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan};
+
+    // Splits memory bound in proportion to non-negative weights
+    auto split = [&](std::vector<double*> parts, std::vector<double> weights) {
+        double total = 0.0;
+        for (double& weight : weights) total += weight = std::max(0.0, weight);
+        for (size_t i = 0; i < parts.size(); i++) *parts[i] = total > 0.0 ? b.memory * weights[i] / total : 0.0;
+    };
+
+    if (std::string(table.vendor) == "intel") {
+        b.frontend = clamp01(rate("fe_undelivered") / w);
+        b.badSpeculation = clamp01((rate("uops_issued") - rate("uops_retired") + w * rate("recovery")) / w);
+        b.retiring = clamp01(rate("uops_retired") / w);
+        b.backend = clamp01(1.0 - b.frontend - b.badSpeculation - b.retiring);
+        // Memory's share of backend-bound cycles (execution stalls plus one-port cycles)
+        double boundCycles = rate("stalls_total") + rate("ports_1");
+        b.memory = clamp01(std::min(1.0, (rate("stalls_mem") + rate("stores")) / boundCycles) * b.backend);
+        double l1 = rate("stalls_mem") - rate("stalls_l1d_miss");
+        double l2 = rate("stalls_l1d_miss") - rate("stalls_l2_miss");
+        double l3 = rate("stalls_l2_miss") - rate("stalls_l3_miss");
+        if (!std::isnan(b.memory)) {
+            split({&b.l1, &b.l2, &b.l3, &b.dram, &b.store}, {l1, l2, l3, rate("stalls_l3_miss"), rate("stores")});
+        }
+    } else {
+        b.frontend = clamp01(rate("fe_slots") / w);
+        b.backend = clamp01(rate("be_slots") / w);
+        b.retiring = clamp01(rate("ops_retired") / w);
+        b.badSpeculation = clamp01((rate("ops_dispatched") - rate("ops_retired")) / w);
+        b.memory = clamp01(b.backend * rate("load_not_complete") / rate("not_complete"));
+        // No per-level stall events: split by where L1D fills came from
+        if (!std::isnan(b.memory)) {
+            split({&b.l2, &b.l3, &b.dram}, {rate("fill_l2"), rate("fill_l3"), rate("fill_dram")});
+        }
+    }
+    b.core = b.backend - b.memory;
+    return b;
+}
+
+// Opens every group of a table on the core PMU and turns the counts into a breakdown
+class TopdownCollector {
+public:
+    // False with `error` when any event of the table cannot be opened
+    bool open(const TopdownTable& table, std::string& error) {
+        table_ = &table;
+        groups_.clear();
+        const char* pmu = nullptr;
+        PerfEventSpec probe;
+        for (const char* candidate : {"cpu", "cpu_core"}) { // cpu_core: P-cores of hybrid parts
+            if (perf_sysfs_event(candidate, "event=0x3c", probe)) {
+                pmu = candidate;
+                break;
+            }
+        }
+        if (!pmu) {
+            error = "no core PMU in /sys/bus/event_source/devices (VM without PMU passthrough?)";
+            return false;
+        }
+        for (const auto& events : table.groups) {
+            groups_.push_back(std::unique_ptr<PerfEventGroup>(new PerfEventGroup()));
+            for (const auto& event : events) {
+                PerfEventSpec spec;
+                if (!perf_sysfs_event(pmu, event.terms, spec) || !groups_.back()->add(event.role, spec)) {
+                    error = std::string("cannot open ") + event.role + " (" + event.terms + ") on " + pmu;
+                    groups_.clear();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void start() {
+        for (auto& group : groups_) group->start();
+    }
+
+    void stop() {
+        for (auto& group : groups_) group->stop();
+    }
+
+    TopdownBreakdown breakdown() const {
+        std::map<std::string, double> perCycle;
+        for (size_t g = 0; g < groups_.size(); g++) {
+            double cycles = groups_[g]->value("cycles");
+            for (const auto& event : table_->groups[g]) {
+                if (std::string(event.role) != "cycles") perCycle[event.role] = groups_[g]->value(event.role) / cycles;
+            }
+        }
+        return topdown_compute(*table_, perCycle);
+    }
+
+    // Smallest share of the measured time any group was on the PMU; the
+    // estimate extrapolates from that share when it is below 1
+    double coverage() const {
+        double least = 1.0;
+        for (const auto& group : groups_) least = std::min(least, group->coverage());
+        return least;
+    }
+
+private:
+    const TopdownTable* table_ = nullptr;
+    std::vector<std::unique_ptr<PerfEventGroup>> groups_;
+};
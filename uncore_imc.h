@@ -0,0 +1,193 @@
+// uncore_imc.h
+// DRAM traffic from the memory controllers' uncore counters: CAS read and
+// write commands (one 64-byte line each) counted by every integrated memory
+// controller channel, opened through perf_event_open like the core events.
+// Supported PMUs, tried in order:
+//   uncore_imc_N               cas_count_read/write (Intel servers: Skylake-SP
+//                              through Sapphire/Emerald Rapids)
+//   uncore_imc_free_running_N  data_read/write (Intel clients since Ice Lake)
+//   uncore_imc                 data_reads/writes (Intel clients up to Comet Lake)
+//   amd_umc_N                  CAS commands by read/write mask (AMD Zen 4 and later)
+// Uncore counters see the whole socket, not just this process, and usually
+// need perf_event_paranoid <= 0 or CAP_PERFMON; open() says why it failed.
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class UncoreImcCounters {
+public:
+    UncoreImcCounters() = default;
+    UncoreImcCounters(const UncoreImcCounters&) = delete;
+    UncoreImcCounters& operator=(const UncoreImcCounters&) = delete;
+
+    ~UncoreImcCounters() { close(); }
+
+    // Opens read and write counters on every channel of the first supported PMU
+    // family; false with `error` when none is present or none can be opened
+    bool open(std::string& error) {
+#ifdef __linux__
+        close();
+        struct Family { const char* prefix; const char* read; const char* write; };
+        const Family families[] = {
+            {"uncore_imc_", "cas_count_read", "cas_count_write"},
+            {"uncore_imc_free_running_", "data_read", "data_write"},
+            {"uncore_imc", "data_reads", "data_writes"},
+            {"amd_umc_", "event=0x0a,rdwrmask=1", "event=0x0a,rdwrmask=2"},
+        };
+        const std::vector<std::string> pmus = listPmus();
+        for (const auto& family : families) {
+            const std::string prefix = family.prefix;
+            const bool exact = prefix.back() != '_'; // Otherwise numbered channels prefix_N
+            for (const auto& pmu : pmus) {
+                if (exact ? pmu != prefix : pmu.compare(0, prefix.size(), prefix) != 0) continue;
+                // uncore_imc_ would also match the free-running PMUs
+                if (prefix == "uncore_imc_" && pmu.find("free_running") != std::string::npos) continue;
+                if (!openChannel(pmu, family.read, false, error) || !openChannel(pmu, family.write, true, error)) {
+                    close();
+                    return false;
+                }
+                channels_++;
+            }
+            if (channels_ > 0) {
+                source_ = exact ? prefix : prefix + "*";
+                return true;
+            }
+        }
+        error = "no memory-controller PMU (uncore_imc*, amd_umc*) in /sys/bus/event_source/devices";
+        return false;
+#else
+        error = "uncore counters need Linux perf_event_open";
+        return false;
+#endif
+    }
+
+    // The counters run continuously; start() and stop() take snapshots
+    void start() {
+        startRead_ = total(false);
+        startWrite_ = total(true);
+    }
+
+    void stop() {
+        stopRead_ = total(false);
+        stopWrite_ = total(true);
+    }
+
+    // Bytes moved between start() and stop(), or NaN when not open
+    double readBytes() const { return counters_.empty() ? std::nan("") : stopRead_ - startRead_; }
+    double writeBytes() const { return counters_.empty() ? std::nan("") : stopWrite_ - startWrite_; }
+
+    const std::string& source() const { return source_; } // PMU name pattern
+    size_t channels() const { return channels_; }
+
+    void close() {
+#ifdef __linux__
+        for (const auto& c : counters_) ::close(c.fd);
+#endif
+        counters_.clear();
+        channels_ = 0;
+        source_.clear();
+    }
+
+private:
+    struct Counter {
+        int fd;
+        double bytesPerCount;
+        bool write;
+    };
+
+#ifdef __linux__
+    static std::vector<std::string> listPmus() {
+        std::vector<std::string> names;
+        DIR* dir = opendir("/sys/bus/event_source/devices");
+        if (!dir) return names;
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+        }
+        closedir(dir);
+        return names;
+    }
+
+    // CPUs to open the PMU on, one per socket, from its cpumask ("0" or "0,28")
+    static std::vector<int> pmuCpus(const std::string& pmu) {
+        std::ifstream file("/sys/bus/event_source/devices/" + pmu + "/cpumask");
+        std::string list, item;
+        std::vector<int> cpus;
+        std::getline(file, list);
+        std::stringstream ss(list);
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) cpus.push_back(std::stoi(item)); // "a-b" ranges: the first CPU suffices
+        }
+        if (cpus.empty()) cpus.push_back(0);
+        return cpus;
+    }
+
+    bool openChannel(const std::string& pmu, const std::string& event, bool write, std::string& error) {
+        PerfEventSpec spec;
+        if (!perf_sysfs_event(pmu, event, spec)) {
+            error = "cannot encode " + event + " for " + pmu;
+            return false;
+        }
+        // Scale files give MiB (or bytes) per count; bare CAS counts are 64-byte lines
+        double bytesPerCount = 64.0;
+        if (spec.unit == "MiB") bytesPerCount = spec.scale * 1048576.0;
+        else if (spec.unit == "bytes" || spec.unit == "B") bytesPerCount = spec.scale;
+
+        for (int cpu : pmuCpus(pmu)) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = spec.type;
+            attr.config = spec.config;
+            attr.config1 = spec.config1;
+            attr.config2 = spec.config2;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // Uncore PMUs reject the exclude_* filters, and count socket-wide (pid -1)
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, -1, cpu, -1, 0));
+            if (fd < 0) {
+                error = "cannot open " + pmu + "/" + event + " on CPU " + std::to_string(cpu) +
+                        " (usually needs perf_event_paranoid <= 0 or CAP_PERFMON)";
+                return false;
+            }
+            counters_.push_back({fd, bytesPerCount, write});
+        }
+        return true;
+    }
+#endif
+
+    // Bytes counted since open, scaled for any multiplexing
+    double total(bool write) const {
+        double bytes = 0.0;
+#ifdef __linux__
+        for (const auto& c : counters_) {
+            if (c.write != write) continue;
+            uint64_t data[3] = {0, 0, 0}; // value, time_enabled, time_running
+            if (read(c.fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            double scale = data[2] ? static_cast<double>(data[1]) / data[2] : 1.0;
+            bytes += static_cast<double>(data[0]) * scale * c.bytesPerCount;
+        }
+#else
+        (void)write;
+#endif
+        return bytes;
+    }
+
+    std::vector<Counter> counters_;
+    size_t channels_ = 0;
+    std::string source_;
+    double startRead_ = 0.0, startWrite_ = 0.0, stopRead_ = 0.0, stopWrite_ = 0.0;
+};
@@ -0,0 +1,159 @@
+// varlen_records.h
+// Three layouts for variable-length records (strings, blobs) read by index:
+//   offsets  - offsets array plus one contiguous byte heap, no padding
+//   padded   - fixed slots sized for the longest record, length in front
+//   inline   - 32-byte small-string slots: records up to 28 bytes live in
+//              the slot, longer ones spill to a heap through an offset
+// All expose view(i) -> {data, length}, so one kernel reads any layout.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct RecordView {
+    const uint8_t* data;
+    size_t length;
+};
+
+// "fixed:N", "uniform:MIN:MAX" or "lognormal:MEDIAN:SIGMA"; lengths are
+// clamped to [1, maxLength]
+struct LengthDistribution {
+    std::string kind = "lognormal";
+    double a = 24.0, b = 1.0;
+    size_t maxLength = 512;
+
+    // False when `spec` is not one of the forms above
+    bool parse(const std::string& spec) {
+        std::stringstream ss(spec);
+        std::string name, first, second;
+        std::getline(ss, name, ':');
+        std::getline(ss, first, ':');
+        std::getline(ss, second, ':');
+        try {
+            if (name == "fixed" && !first.empty()) {
+                a = b = std::stod(first);
+            } else if ((name == "uniform" || name == "lognormal") && !first.empty() && !second.empty()) {
+                a = std::stod(first);
+                b = std::stod(second);
+            } else {
+                return false;
+            }
+        } catch (const std::logic_error&) { // stod's invalid_argument / out_of_range
+            return false;
+        }
+        kind = name;
+        return a > 0.0 && b >= 0.0 && (kind != "uniform" || b >= a);
+    }
+
+    template<typename Rng>
+    size_t draw(Rng& rng) const {
+        double length = a;
+        if (kind == "uniform") length = std::uniform_real_distribution<double>(a, b + 1.0)(rng);
+        else if (kind == "lognormal") length = std::lognormal_distribution<double>(std::log(a), b)(rng);
+        return std::min(maxLength, std::max<size_t>(1, static_cast<size_t>(length)));
+    }
+};
+
+class OffsetsHeap {
+public:
+    explicit OffsetsHeap(const std::vector<std::vector<uint8_t>>& records) : offsets_(records.size() + 1, 0) {
+        for (size_t i = 0; i < records.size(); i++) offsets_[i + 1] = offsets_[i] + records[i].size();
+        heap_.resize(offsets_.back());
+        for (size_t i = 0; i < records.size(); i++) {
+            std::copy(records[i].begin(), records[i].end(), heap_.begin() + offsets_[i]);
+        }
+    }
+
+    RecordView view(size_t i) const { return {heap_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]}; }
+    size_t bytes() const { return offsets_.size() * sizeof(uint64_t) + heap_.size(); }
+
+private:
+    std::vector<uint64_t> offsets_;
+    std::vector<uint8_t> heap_;
+};
+
+class PaddedSlots {
+public:
+    explicit PaddedSlots(const std::vector<std::vector<uint8_t>>& records) {
+        size_t longest = 0;
+        for (const auto& record : records) longest = std::max(longest, record.size());
+        slotBytes_ = (sizeof(uint32_t) + longest + 7) & ~size_t(7);
+        slots_.assign(records.size() * slotBytes_, 0);
+        for (size_t i = 0; i < records.size(); i++) {
+            uint8_t* slot = slots_.data() + i * slotBytes_;
+            uint32_t length = static_cast<uint32_t>(records[i].size());
+            std::memcpy(slot, &length, sizeof(length));
+            std::copy(records[i].begin(), records[i].end(), slot + sizeof(length));
+        }
+    }
+
+    RecordView view(size_t i) const {
+        const uint8_t* slot = slots_.data() + i * slotBytes_;
+        uint32_t length;
+        std::memcpy(&length, slot, sizeof(length));
+        return {slot + sizeof(length), length};
+    }
+    size_t bytes() const { return slots_.size(); }
+    size_t slotBytes() const { return slotBytes_; }
+
+private:
+    std::vector<uint8_t> slots_;
+    size_t slotBytes_ = 0;
+};
+
+class InlineStrings {
+public:
+    static constexpr size_t INLINE_BYTES = 28;
+
+    explicit InlineStrings(const std::vector<std::vector<uint8_t>>& records) : slots_(records.size()) {
+        for (size_t i = 0; i < records.size(); i++) {
+            Slot& slot = slots_[i];
+            slot.length = static_cast<uint32_t>(records[i].size());
+            if (slot.length <= INLINE_BYTES) {
+                std::copy(records[i].begin(), records[i].end(), slot.bytes);
+            } else {
+                uint64_t offset = heap_.size();
+                std::memcpy(slot.bytes + 4, &offset, sizeof(offset));
+                heap_.insert(heap_.end(), records[i].begin(), records[i].end());
+            }
+        }
+    }
+
+    RecordView view(size_t i) const {
+        const Slot& slot = slots_[i];
+        if (slot.length <= INLINE_BYTES) return {slot.bytes, slot.length};
+        uint64_t offset;
+        std::memcpy(&offset, slot.bytes + 4, sizeof(offset));
+        return {heap_.data() + offset, slot.length};
+    }
+    size_t bytes() const { return slots_.size() * sizeof(Slot) + heap_.size(); }
+
+private:
+    struct alignas(32) Slot {
+        uint32_t length;
+        uint8_t bytes[INLINE_BYTES]; // Record bytes, or an 8-byte heap offset at bytes + 4
+    };
+    std::vector<Slot> slots_;
+    std::vector<uint8_t> heap_;
+};
+
+// Sums the record 8 bytes at a time, then the tail
+inline uint64_t record_checksum(const uint8_t* data, size_t length) {
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        sum += word;
+    }
+    for (; i < length; i++) sum += data[i];
+    return sum;
+}